@@ -5,19 +5,36 @@
 #pragma once
 
 
+#include <atomic>
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <memory>
 #include "generator.hh"
+#include "perf_sampler.hh"
+#include "slow_ops.hh"
+#include "trace_recorder.hh"
 #include "rocksdb/db.h"
+#include "rocksdb/perf_context.h"
+#include "rocksdb/utilities/transaction_db.h"
+#include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "metrics.hh"
 #include "prometheus/counter.h"
 #include "prometheus/histogram.h"
 
 
+enum TxnMode {
+    TXN_NONE, TXN_PESSIMISTIC, TXN_OPTIMISTIC
+};
+
 class Benchmark : public BaseMetrics {
 public:
-    Benchmark(uint64_t nums, int value_size, bool sync = true, bool disable_wal = false)
+    Benchmark(uint64_t nums, int value_size, bool sync = true, bool disable_wal = false,
+              KeyFormat key_format = KeyFormat(), uint64_t perf_sample_every = 0,
+              SlowOpRecorder *slow_ops = nullptr)
             : sync_(sync), disable_wal_(disable_wal), value_size_(value_size), write_nums_(nums),
+              key_format_(key_format), perf_sample_every_(perf_sample_every), slow_ops_(slow_ops), stop_(false),
               ROCKSDB_OPERATOR_METRICS(prometheus::BuildCounter()
                                                .Name("rocksdb_operator")
                                                .Help("rocksdb operator command counter")
@@ -30,33 +47,81 @@ public:
                                                 .BucketBoundaries(
                                                         prometheus::Histogram::ExponentialBuckets(0.5, 2.0, 20))
                                                 .Register(*registry_)
-                                                ) {
+                                                ),
+              ROCKSDB_OPERATOR_BYTES_METRICS(prometheus::BuildCounter()
+                                                     .Name("rocksdb_operator_bytes")
+                                                     .Help("rocksdb operator written key and value bytes counter")
+                                                     .LabelNamesVec({"type"})
+                                                     .Register(*registry_)),
+              ROCKSDB_TXN_RESULT_METRICS(prometheus::BuildCounter()
+                                                 .Name("rocksdb_txn_result")
+                                                 .Help("rocksdb transaction result counter")
+                                                 .LabelNamesVec({"type", "result"})
+                                                 .Register(*registry_)),
+              ROCKSDB_TXN_COMMIT_DURATION(prometheus::BuildHistogram()
+                                                  .Name("rocksdb_txn_commit_micros")
+                                                  .Help("rocksdb transaction commit time histogram")
+                                                  .LabelNamesVec({"type"})
+                                                  .BucketBoundaries(
+                                                          prometheus::Histogram::ExponentialBuckets(1, 2.0, 24))
+                                                  .Register(*registry_)),
+              ROCKSDB_TXN_LOCK_WAIT_DURATION(prometheus::BuildHistogram()
+                                                     .Name("rocksdb_txn_lock_wait_micros")
+                                                     .Help("rocksdb transaction GetForUpdate time histogram (key lock waits and the reads), sum of the keys of one txn")
+                                                     .LabelNamesVec({"type"})
+                                                     .BucketBoundaries(
+                                                             prometheus::Histogram::ExponentialBuckets(1, 2.0, 24))
+                                                     .Register(*registry_)),
+              ROCKSDB_GET_RESULT_METRICS(prometheus::BuildCounter()
+                                                 .Name("rocksdb_get_result")
+                                                 .Help("rocksdb get found and not found counter")
+                                                 .LabelNamesVec({"type", "result"})
+                                                 .Register(*registry_)),
+              ROCKSDB_PERF_STAGE_DURATION(prometheus::BuildHistogram()
+                                                  .Name("rocksdb_perf_stage_micros")
+                                                  .Help("rocksdb operator time of each stage histogram, of the sampled ops")
+                                                  .LabelNamesVec({"type", "stage"})
+                                                  .BucketBoundaries(
+                                                          prometheus::Histogram::ExponentialBuckets(0.1, 2.0, 24))
+                                                  .Register(*registry_)) {
 
     }
 
-    void DoPut(WriteMode write_mode,
+    void DoPut(int thread_index,
+               int thread_num,
+               WriteMode write_mode,
                rocksdb::DB *db,
                rocksdb::ColumnFamilyHandle *db_cf) {
-        KeyGenerator key_generator(write_mode, write_nums_);
+        KeyGenerator key_generator(write_mode, write_nums_, thread_index, thread_num);
         RandomGenerator value_generator(value_size_);
         rocksdb::WriteOptions write_options;
         write_options.sync = sync_;
         write_options.disableWAL = disable_wal_;
         auto &metrics_counter = ROCKSDB_OPERATOR_METRICS.WithLabelValues({"put"});
+        auto &metrics_bytes = ROCKSDB_OPERATOR_BYTES_METRICS.WithLabelValues({"put"});
         auto &metrics_duration = ROCKSDB_OPERATOR_DURATION.WithLabelValues({"put"});
+        PerfSampler perf_sampler(ROCKSDB_PERF_STAGE_DURATION, "put", PERF_WRITE, perf_sample_every_);
+        auto slow_op_tracker = slow_ops_ ? slow_ops_->NewTracker() : nullptr;
         size_t count_sum = 0;
-        while (true) {
+        size_t bytes_sum = 0;
+        while (!stop_) {
             auto now = std::chrono::system_clock::now();
-            auto s = db->Put(write_options, db_cf,
-                    std::to_string(key_generator.Next()),
+            auto key = key_format_.Key(key_generator.Next());
+            perf_sampler.Begin();
+            auto s = db->Put(write_options, db_cf, key,
                     value_generator.Generate(value_size_));
             assert(s.ok());
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now() - now);
+            auto latency = std::chrono::system_clock::now() - now;
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+            perf_sampler.End();
+            RecordSlowOp(slow_op_tracker, "put", key, value_size_, 1, latency, db, db_cf);
             count_sum++;
+            bytes_sum += key.size() + value_size_;
             if (count_sum == 50) {
                 metrics_counter.Increment(count_sum);
+                metrics_bytes.Increment(bytes_sum);
                 count_sum = 0;
+                bytes_sum = 0;
             }
             metrics_duration.Observe(duration.count());
         }
@@ -66,37 +131,53 @@ public:
              rocksdb::ColumnFamilyHandle *db_cf,
              WriteMode write_mode = RANDOM) {
         for (int i = 0; i < thread_num; i++)
-            threads_.push_back(std::thread(std::bind(&Benchmark::DoPut, this, write_mode, db, db_cf)));
+            threads_.push_back(std::thread(std::bind(&Benchmark::DoPut, this, i, thread_num, write_mode, db, db_cf)));
     }
 
 
-    void DoBatchPut(int batch_nums,
+    void DoBatchPut(int thread_index,
+                    int thread_num,
+                    int batch_nums,
                     WriteMode write_mode,
                     rocksdb::DB *db,
                     rocksdb::ColumnFamilyHandle *db_cf) {
-        KeyGenerator key_generator(write_mode, write_nums_);
+        KeyGenerator key_generator(write_mode, write_nums_, thread_index, thread_num);
         RandomGenerator value_generator(value_size_);
         rocksdb::WriteOptions write_options;
         write_options.sync = sync_;
         write_options.disableWAL = disable_wal_;
         auto &metrics_counter = ROCKSDB_OPERATOR_METRICS.WithLabelValues({"put"});
+        auto &metrics_bytes = ROCKSDB_OPERATOR_BYTES_METRICS.WithLabelValues({"put"});
         auto &metrics_duration = ROCKSDB_OPERATOR_DURATION.WithLabelValues({"put"});
+        PerfSampler perf_sampler(ROCKSDB_PERF_STAGE_DURATION, "batch", PERF_WRITE, perf_sample_every_);
+        auto slow_op_tracker = slow_ops_ ? slow_ops_->NewTracker() : nullptr;
         size_t count_sum = 0;
-        while (true) {
+        size_t bytes_sum = 0;
+        while (!stop_) {
             auto now = std::chrono::system_clock::now();
             rocksdb::WriteBatch batch;
+            std::string first_key;
             for (int i = 0; i< batch_nums; i++) {
-                batch.Put(db_cf, std::to_string(key_generator.Next()),
-                          value_generator.Generate(value_size_));
+                auto key = key_format_.Key(key_generator.Next());
+                if (i == 0) {
+                    first_key = key;
+                }
+                batch.Put(db_cf, key, value_generator.Generate(value_size_));
+                bytes_sum += key.size() + value_size_;
             }
+            perf_sampler.Begin();
             auto s = db->Write(write_options, &batch);
             assert(s.ok());
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now() - now);
+            auto latency = std::chrono::system_clock::now() - now;
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+            perf_sampler.End();
+            RecordSlowOp(slow_op_tracker, "batch", first_key, value_size_, batch_nums, latency, db, db_cf);
             count_sum+= batch_nums;
             if (count_sum > 100) {
                 metrics_counter.Increment(count_sum);
+                metrics_bytes.Increment(bytes_sum);
                 count_sum = 0;
+                bytes_sum = 0;
             }
             metrics_duration.Observe(duration.count());
         }
@@ -106,10 +187,244 @@ public:
                   rocksdb::ColumnFamilyHandle *db_cf,
                   WriteMode write_mode = RANDOM) {
         for (int i = 0; i < thread_num; i++)
-            threads_.push_back(std::thread(std::bind(&Benchmark::DoBatchPut, this,
+            threads_.push_back(std::thread(std::bind(&Benchmark::DoBatchPut, this, i, thread_num,
                                                      batch_nums, write_mode, db, db_cf)));
     }
 
+    /*
+     * point lookups of the keys put/batch write (key < nums), or with miss of keys never
+     * written (nums <= key < 2 * nums) which are inside the key range of every sst, so
+     * only the filters keep them from reading data blocks
+     */
+    void DoGet(bool miss,
+               WriteMode write_mode,
+               rocksdb::DB *db,
+               rocksdb::ColumnFamilyHandle *db_cf) {
+        KeyGenerator key_generator(write_mode == UNIQUE_RANDOM ? RANDOM : write_mode, write_nums_);
+        rocksdb::ReadOptions read_options;
+        const char *type = miss ? "get_miss" : "get";
+        auto &metrics_counter = ROCKSDB_OPERATOR_METRICS.WithLabelValues({type});
+        auto &metrics_bytes = ROCKSDB_OPERATOR_BYTES_METRICS.WithLabelValues({type});
+        auto &metrics_duration = ROCKSDB_OPERATOR_DURATION.WithLabelValues({type});
+        auto &get_found = ROCKSDB_GET_RESULT_METRICS.WithLabelValues({type, "found"});
+        auto &get_not_found = ROCKSDB_GET_RESULT_METRICS.WithLabelValues({type, "not_found"});
+        PerfSampler perf_sampler(ROCKSDB_PERF_STAGE_DURATION, type, PERF_GET, perf_sample_every_);
+        auto slow_op_tracker = slow_ops_ ? slow_ops_->NewTracker() : nullptr;
+        std::string value;
+        size_t count_sum = 0;
+        size_t found_sum = 0;
+        size_t bytes_sum = 0;
+        while (!stop_) {
+            auto now = std::chrono::system_clock::now();
+            auto key = key_format_.Key(key_generator.Next() % write_nums_ + (miss ? write_nums_ : 0));
+            perf_sampler.Begin();
+            auto s = db->Get(read_options, db_cf, key, &value);
+            assert(s.ok() || s.IsNotFound());
+            auto latency = std::chrono::system_clock::now() - now;
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+            perf_sampler.End();
+            RecordSlowOp(slow_op_tracker, type, key, s.ok() ? value.size() : 0, 1, latency, db, db_cf);
+            count_sum++;
+            if (s.ok()) {
+                found_sum++;
+                bytes_sum += key.size() + value.size();
+            }
+            if (count_sum == 50) {
+                metrics_counter.Increment(count_sum);
+                metrics_bytes.Increment(bytes_sum);
+                get_found.Increment(found_sum);
+                get_not_found.Increment(count_sum - found_sum);
+                count_sum = 0;
+                found_sum = 0;
+                bytes_sum = 0;
+            }
+            metrics_duration.Observe(duration.count());
+        }
+    }
+
+    void Get(int thread_num, bool miss, rocksdb::DB *db,
+             rocksdb::ColumnFamilyHandle *db_cf,
+             WriteMode write_mode = RANDOM) {
+        for (int i = 0; i < thread_num; i++)
+            threads_.push_back(std::thread(std::bind(&Benchmark::DoGet, this, miss, write_mode, db, db_cf)));
+    }
+
+    /*
+     * Seek to a tenant prefix (or to a written key without --key_prefix_num) and read up to
+     * nexts keys of it, with a prefix extractor the iterator stays inside the prefix
+     */
+    void DoSeek(int nexts,
+                WriteMode write_mode,
+                rocksdb::DB *db,
+                rocksdb::ColumnFamilyHandle *db_cf) {
+        KeyGenerator key_generator(write_mode == UNIQUE_RANDOM ? RANDOM : write_mode, write_nums_);
+        rocksdb::ReadOptions read_options;
+        read_options.prefix_same_as_start = key_format_.HasPrefix();
+        auto &metrics_counter = ROCKSDB_OPERATOR_METRICS.WithLabelValues({"seek"});
+        auto &metrics_bytes = ROCKSDB_OPERATOR_BYTES_METRICS.WithLabelValues({"seek"});
+        auto &metrics_duration = ROCKSDB_OPERATOR_DURATION.WithLabelValues({"seek"});
+        PerfSampler perf_sampler(ROCKSDB_PERF_STAGE_DURATION, "seek", PERF_SEEK, perf_sample_every_);
+        auto slow_op_tracker = slow_ops_ ? slow_ops_->NewTracker() : nullptr;
+        size_t count_sum = 0;
+        size_t bytes_sum = 0;
+        while (!stop_) {
+            auto now = std::chrono::system_clock::now();
+            auto num = key_generator.Next() % write_nums_;
+            auto target = key_format_.HasPrefix() ? key_format_.Prefix(num % key_format_.PrefixNum())
+                                                  : key_format_.Key(num);
+            perf_sampler.Begin();
+            std::unique_ptr<rocksdb::Iterator> iter(db->NewIterator(read_options, db_cf));
+            iter->Seek(target);
+            for (int i = 0; i < nexts && iter->Valid(); i++) {
+                bytes_sum += iter->key().size() + iter->value().size();
+                iter->Next();
+            }
+            assert(iter->status().ok());
+            auto latency = std::chrono::system_clock::now() - now;
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+            perf_sampler.End();
+            RecordSlowOp(slow_op_tracker, "seek", target, 0, nexts, latency, db, db_cf);
+            count_sum++;
+            if (count_sum == 50) {
+                metrics_counter.Increment(count_sum);
+                metrics_bytes.Increment(bytes_sum);
+                count_sum = 0;
+                bytes_sum = 0;
+            }
+            metrics_duration.Observe(duration.count());
+        }
+    }
+
+    void Seek(int thread_num, int nexts, rocksdb::DB *db,
+              rocksdb::ColumnFamilyHandle *db_cf,
+              WriteMode write_mode = RANDOM) {
+        for (int i = 0; i < thread_num; i++)
+            threads_.push_back(std::thread(std::bind(&Benchmark::DoSeek, this, nexts, write_mode, db, db_cf)));
+    }
+
+    /*
+     * read-modify-write of txn_keys keys in one transaction:
+     *   pessimistic -- GetForUpdate locks the key, fails with deadlock/timeout
+     *   optimistic  -- GetForUpdate tracks the key, Commit fails with busy on conflict
+     */
+    void DoTxn(TxnMode txn_mode,
+               int txn_keys,
+               bool deadlock_detect,
+               WriteMode write_mode,
+               rocksdb::DB *db,
+               rocksdb::ColumnFamilyHandle *db_cf) {
+        KeyGenerator key_generator(write_mode, write_nums_);
+        RandomGenerator value_generator(value_size_);
+        rocksdb::WriteOptions write_options;
+        write_options.sync = sync_;
+        write_options.disableWAL = disable_wal_;
+        rocksdb::ReadOptions read_options;
+        rocksdb::TransactionOptions txn_options;
+        txn_options.deadlock_detect = deadlock_detect;
+        rocksdb::OptimisticTransactionOptions optimistic_txn_options;
+
+        const char *type = txn_mode == TXN_PESSIMISTIC ? "pessimistic" : "optimistic";
+        auto &metrics_counter = ROCKSDB_OPERATOR_METRICS.WithLabelValues({"txn"});
+        auto &metrics_duration = ROCKSDB_OPERATOR_DURATION.WithLabelValues({"txn"});
+        auto &commit_duration = ROCKSDB_TXN_COMMIT_DURATION.WithLabelValues({type});
+        auto &lock_wait_duration = ROCKSDB_TXN_LOCK_WAIT_DURATION.WithLabelValues({type});
+        auto &txn_committed = ROCKSDB_TXN_RESULT_METRICS.WithLabelValues({type, "committed"});
+        auto &txn_deadlock = ROCKSDB_TXN_RESULT_METRICS.WithLabelValues({type, "deadlock"});
+        auto &txn_timeout = ROCKSDB_TXN_RESULT_METRICS.WithLabelValues({type, "timeout"});
+        auto &txn_conflict = ROCKSDB_TXN_RESULT_METRICS.WithLabelValues({type, "conflict"});
+        auto &txn_try_again = ROCKSDB_TXN_RESULT_METRICS.WithLabelValues({type, "try_again"});
+        auto &txn_error = ROCKSDB_TXN_RESULT_METRICS.WithLabelValues({type, "error"});
+        PerfSampler perf_sampler(ROCKSDB_PERF_STAGE_DURATION, "txn", PERF_TXN, perf_sample_every_);
+        auto slow_op_tracker = slow_ops_ ? slow_ops_->NewTracker() : nullptr;
+
+        rocksdb::Transaction *txn = nullptr;
+        std::string old_value;
+        size_t count_sum = 0;
+        while (!stop_) {
+            auto now = std::chrono::system_clock::now();
+            perf_sampler.Begin();
+            if (txn_mode == TXN_PESSIMISTIC) {
+                txn = static_cast<rocksdb::TransactionDB *>(db)->BeginTransaction(
+                        write_options, txn_options, txn);
+            } else {
+                txn = static_cast<rocksdb::OptimisticTransactionDB *>(db)->BeginTransaction(
+                        write_options, optimistic_txn_options, txn);
+            }
+
+            rocksdb::Status s;
+            std::string first_key;
+            // the perf context key_lock_wait_time needs the perf level of the sampled txns only,
+            // the steady clock around GetForUpdate times the lock waits of every txn
+            std::chrono::steady_clock::duration lock_wait(0);
+            for (int i = 0; i < txn_keys && s.ok(); i++) {
+                auto key = key_format_.Key(key_generator.Next());
+                if (i == 0) {
+                    first_key = key;
+                }
+                auto lock_now = std::chrono::steady_clock::now();
+                s = txn->GetForUpdate(read_options, db_cf, key, &old_value);
+                lock_wait += std::chrono::steady_clock::now() - lock_now;
+                if (s.IsNotFound()) {
+                    s = rocksdb::Status::OK();
+                }
+                if (s.ok()) {
+                    s = txn->Put(db_cf, key, value_generator.Generate(value_size_));
+                }
+            }
+            if (s.ok()) {
+                auto commit_now = std::chrono::system_clock::now();
+                s = txn->Commit();
+                commit_duration.Observe(std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::system_clock::now() - commit_now).count());
+            } else {
+                txn->Rollback();
+            }
+            perf_sampler.End();
+            if (txn_mode == TXN_PESSIMISTIC) {
+                lock_wait_duration.Observe(
+                        std::chrono::duration_cast<std::chrono::microseconds>(lock_wait).count());
+            }
+
+            if (s.ok()) {
+                txn_committed.Increment();
+            } else if (s.IsDeadlock()) {
+                txn_deadlock.Increment();
+            } else if (s.IsTimedOut()) {
+                txn_timeout.Increment();
+            } else if (s.IsBusy()) {
+                txn_conflict.Increment();
+            } else if (s.IsTryAgain()) {
+                txn_try_again.Increment();
+            } else {
+                txn_error.Increment();
+            }
+
+            auto latency = std::chrono::system_clock::now() - now;
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(latency);
+            RecordSlowOp(slow_op_tracker, "txn", first_key, value_size_, txn_keys, latency, db, db_cf);
+            count_sum++;
+            if (count_sum == 50) {
+                metrics_counter.Increment(count_sum);
+                count_sum = 0;
+            }
+            metrics_duration.Observe(duration.count());
+        }
+        delete txn;
+    }
+
+    void Txn(int thread_num, TxnMode txn_mode, int txn_keys, bool deadlock_detect,
+             rocksdb::DB *db, rocksdb::ColumnFamilyHandle *db_cf,
+             WriteMode write_mode = SKEWED) {
+        for (int i = 0; i < thread_num; i++)
+            threads_.push_back(std::thread(std::bind(&Benchmark::DoTxn, this, txn_mode, txn_keys,
+                                                     deadlock_detect, write_mode, db, db_cf)));
+    }
+
+    // the threads return after their current op
+    void Stop() {
+        stop_ = true;
+    }
+
     void Join() {
         for (auto &thread : threads_)
             thread.join();
@@ -117,13 +432,62 @@ public:
 
 
 private:
+    /*
+     * keeps the op if it is one of the slowest of the thread, with the stall condition, level0
+     * files and immutable memtables read right after it returned
+     */
+    void RecordSlowOp(SlowOpTracker *tracker, const char *type, const std::string &key, size_t value_size,
+                      size_t batch_size, std::chrono::system_clock::duration latency,
+                      rocksdb::DB *db, rocksdb::ColumnFamilyHandle *db_cf) {
+        auto latency_micros = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+        if (tracker == nullptr || !tracker->IsSlow(latency_micros)) {
+            return;
+        }
+        SlowOp op;
+        memset(&op, 0, sizeof(op));
+        op.unix_micros = uint64_t(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        op.latency_micros = latency_micros;
+        TraceRecorder::CopyName(op.type, sizeof(op.type), type);
+        TraceRecorder::CopyName(op.db, sizeof(op.db), db->GetName());
+        TraceRecorder::CopyName(op.cf, sizeof(op.cf), db_cf->GetName());
+        TraceRecorder::CopyName(op.key, sizeof(op.key), key);
+        op.value_size = uint32_t(value_size);
+        op.batch_size = uint32_t(batch_size);
+
+        uint64_t value = 0;
+        const char *stall = "normal";
+        if (db->GetIntProperty(rocksdb::DB::Properties::kIsWriteStopped, &value) && value > 0) {
+            stall = "stopped";
+        } else if (db->GetIntProperty(rocksdb::DB::Properties::kActualDelayedWriteRate, &value) && value > 0) {
+            stall = "delayed";
+        }
+        TraceRecorder::CopyName(op.stall, sizeof(op.stall), stall);
+        std::string l0_files;
+        op.l0_files = db->GetProperty(db_cf, rocksdb::DB::Properties::kNumFilesAtLevelPrefix + "0", &l0_files)
+                      ? std::atoll(l0_files.c_str()) : -1;
+        op.imm_memtables = db->GetIntProperty(db_cf, rocksdb::DB::Properties::kNumImmutableMemTable, &value)
+                           ? int64_t(value) : -1;
+        tracker->Record(op);
+    }
+
     bool sync_;
     bool disable_wal_;
     int value_size_;
     uint64_t write_nums_;
+    KeyFormat key_format_;
+    uint64_t perf_sample_every_;
+    SlowOpRecorder *slow_ops_;
+    std::atomic<bool> stop_;
     std::vector<std::thread> threads_;
     prometheus::Family<prometheus::Counter> &ROCKSDB_OPERATOR_METRICS;
     prometheus::Family<prometheus::Histogram> &ROCKSDB_OPERATOR_DURATION;
+    prometheus::Family<prometheus::Counter> &ROCKSDB_OPERATOR_BYTES_METRICS;
+    prometheus::Family<prometheus::Counter> &ROCKSDB_TXN_RESULT_METRICS;
+    prometheus::Family<prometheus::Histogram> &ROCKSDB_TXN_COMMIT_DURATION;
+    prometheus::Family<prometheus::Histogram> &ROCKSDB_TXN_LOCK_WAIT_DURATION;
+    prometheus::Family<prometheus::Counter> &ROCKSDB_GET_RESULT_METRICS;
+    prometheus::Family<prometheus::Histogram> &ROCKSDB_PERF_STAGE_DURATION;
 };
 
 
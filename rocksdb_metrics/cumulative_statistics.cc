@@ -0,0 +1,179 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <cctype>
+#include <functional>
+#include <limits>
+#include <thread>
+#include "cumulative_statistics.hh"
+
+static int GetBucket(uint64_t value) {
+    if (value <= 1) {
+        return 0;
+    }
+    // the smallest i of value <= 2^i
+    int bucket = 64 - __builtin_clzll(value - 1);
+    return bucket < CumulativeStatistics::BUCKET_NUM - 1 ? bucket : CumulativeStatistics::BUCKET_NUM - 1;
+}
+
+static int GetShard(int shard_num) {
+    static thread_local int shard = int(std::hash<std::thread::id>()(std::this_thread::get_id()) % shard_num);
+    return shard;
+}
+
+CumulativeStatistics::CumulativeStatistics()
+        : target_(rocksdb::CreateDBStatistics()),
+          buckets_(new Buckets[rocksdb::HISTOGRAM_ENUM_MAX * SHARD_NUM]) {
+    for (int i = 0; i < rocksdb::HISTOGRAM_ENUM_MAX * SHARD_NUM; i++) {
+        for (auto &count : buckets_[i].counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        buckets_[i].sum.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t CumulativeStatistics::getTickerCount(uint32_t ticker_type) const {
+    return target_->getTickerCount(ticker_type);
+}
+
+void CumulativeStatistics::histogramData(uint32_t type, rocksdb::HistogramData *const data) const {
+    target_->histogramData(type, data);
+}
+
+std::string CumulativeStatistics::getHistogramString(uint32_t type) const {
+    return target_->getHistogramString(type);
+}
+
+void CumulativeStatistics::recordTick(uint32_t ticker_type, uint64_t count) {
+    target_->recordTick(ticker_type, count);
+}
+
+void CumulativeStatistics::setTickerCount(uint32_t ticker_type, uint64_t count) {
+    target_->setTickerCount(ticker_type, count);
+}
+
+uint64_t CumulativeStatistics::getAndResetTickerCount(uint32_t ticker_type) {
+    return target_->getAndResetTickerCount(ticker_type);
+}
+
+void CumulativeStatistics::recordInHistogram(uint32_t histogram_type, uint64_t value) {
+    if (get_stats_level() <= rocksdb::StatsLevel::kExceptHistogramOrTimers) {
+        return;
+    }
+    target_->recordInHistogram(histogram_type, value);
+    if (histogram_type >= uint32_t(rocksdb::HISTOGRAM_ENUM_MAX)) {
+        return;
+    }
+    auto &buckets = buckets_[histogram_type * SHARD_NUM + GetShard(SHARD_NUM)];
+    buckets.counts[GetBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    buckets.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+rocksdb::Status CumulativeStatistics::Reset() {
+    return target_->Reset();
+}
+
+std::string CumulativeStatistics::ToString() const {
+    return target_->ToString();
+}
+
+bool CumulativeStatistics::getTickerMap(std::map<std::string, uint64_t> *map) const {
+    return target_->getTickerMap(map);
+}
+
+bool CumulativeStatistics::HistEnabledForType(uint32_t type) const {
+    return target_->HistEnabledForType(type);
+}
+
+void CumulativeStatistics::GetHistogramBuckets(uint32_t type, uint64_t *buckets, uint64_t *sum,
+                                               uint64_t *count) const {
+    *sum = 0;
+    *count = 0;
+    for (int i = 0; i < BUCKET_NUM; i++) {
+        buckets[i] = 0;
+    }
+    for (int shard = 0; shard < SHARD_NUM; shard++) {
+        auto &shard_buckets = buckets_[type * SHARD_NUM + shard];
+        for (int i = 0; i < BUCKET_NUM; i++) {
+            auto n = shard_buckets.counts[i].load(std::memory_order_relaxed);
+            buckets[i] += n;
+            *count += n;
+        }
+        *sum += shard_buckets.sum.load(std::memory_order_relaxed);
+    }
+}
+
+double CumulativeStatistics::BucketUpperBound(int bucket) {
+    return double(uint64_t(1) << bucket);
+}
+
+
+void CumulativeHistogramCollector::Add(const std::string &name,
+                                       const std::shared_ptr<CumulativeStatistics> &statistics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics_.push_back(std::make_pair(name, statistics));
+}
+
+std::vector<prometheus::MetricFamily> CumulativeHistogramCollector::Collect() {
+    std::vector<std::pair<std::string, std::shared_ptr<CumulativeStatistics>>> statistics;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        statistics = statistics_;
+    }
+
+    std::vector<prometheus::MetricFamily> families;
+    for (auto &pair : rocksdb::HistogramsNameMap) {
+        // name -> buckets, sum, count of the rocksdbs of the name
+        std::map<std::string, std::vector<uint64_t>> dbs;
+        for (auto &db : statistics) {
+            uint64_t buckets[CumulativeStatistics::BUCKET_NUM];
+            uint64_t sum, count;
+            db.second->GetHistogramBuckets(pair.first, buckets, &sum, &count);
+            auto &total = dbs[db.first];
+            total.resize(CumulativeStatistics::BUCKET_NUM + 2, 0);
+            for (int i = 0; i < CumulativeStatistics::BUCKET_NUM; i++) {
+                total[i] += buckets[i];
+            }
+            total[CumulativeStatistics::BUCKET_NUM] += sum;
+            total[CumulativeStatistics::BUCKET_NUM + 1] += count;
+        }
+
+        prometheus::MetricFamily family;
+        family.name = pair.second;
+        // engine_hist_, the gauges of the summaries already own names like engine_sst_read_micros
+        if (family.name.compare(0, 8, "rocksdb.") == 0) {
+            family.name = "engine_hist_" + family.name.substr(8);
+        }
+        for (auto &c : family.name) {
+            c = isalnum(c) ? c : '_';
+        }
+        family.help = "Histogram of " + pair.second + " since the rocksdb is opened";
+        family.type = prometheus::MetricType::Histogram;
+        for (auto &db : dbs) {
+            auto &total = db.second;
+            if (total[CumulativeStatistics::BUCKET_NUM + 1] == 0) {
+                continue;
+            }
+            prometheus::ClientMetric metric;
+            metric.label.push_back(prometheus::ClientMetric::Label{"db", db.first});
+            metric.histogram.sample_sum = double(total[CumulativeStatistics::BUCKET_NUM]);
+            metric.histogram.sample_count = total[CumulativeStatistics::BUCKET_NUM + 1];
+            uint64_t cumulative = 0;
+            for (int i = 0; i < CumulativeStatistics::BUCKET_NUM; i++) {
+                cumulative += total[i];
+                prometheus::ClientMetric::Bucket bucket;
+                bucket.cumulative_count = cumulative;
+                bucket.upper_bound = i == CumulativeStatistics::BUCKET_NUM - 1
+                                     ? std::numeric_limits<double>::infinity()
+                                     : CumulativeStatistics::BucketUpperBound(i);
+                metric.histogram.bucket.push_back(bucket);
+            }
+            family.metric.push_back(metric);
+        }
+        if (!family.metric.empty()) {
+            families.push_back(family);
+        }
+    }
+    return families;
+}
@@ -0,0 +1,89 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <rocksdb/statistics.h>
+#include <prometheus/collectable.h>
+#include <prometheus/metric_family.h>
+
+
+/*
+ * A rocksdb Statistics forwarding everything to CreateDBStatistics(), which also counts every
+ * histogram record into fixed power of two buckets. The buckets, sum and count only grow, they
+ * are exported as prometheus histograms (histogram_quantile aggregates them over instances) and
+ * nothing has to call Reset.
+ */
+class CumulativeStatistics : public rocksdb::Statistics {
+public:
+    // upper bounds 1, 2, 4, ..., 2^(BUCKET_NUM - 2), the last bucket is +Inf
+    static const int BUCKET_NUM = 34;
+
+    CumulativeStatistics();
+
+    const char *Name() const override { return "CumulativeStatistics"; }
+
+    uint64_t getTickerCount(uint32_t ticker_type) const override;
+
+    void histogramData(uint32_t type, rocksdb::HistogramData *const data) const override;
+
+    std::string getHistogramString(uint32_t type) const override;
+
+    void recordTick(uint32_t ticker_type, uint64_t count) override;
+
+    void setTickerCount(uint32_t ticker_type, uint64_t count) override;
+
+    uint64_t getAndResetTickerCount(uint32_t ticker_type) override;
+
+    void recordInHistogram(uint32_t histogram_type, uint64_t value) override;
+
+    // resets the target only, the buckets stay cumulative
+    rocksdb::Status Reset() override;
+
+    std::string ToString() const override;
+
+    bool getTickerMap(std::map<std::string, uint64_t> *map) const override;
+
+    bool HistEnabledForType(uint32_t type) const override;
+
+    // count of every bucket (not cumulative), sum and count of a histogram since the start
+    void GetHistogramBuckets(uint32_t type, uint64_t *buckets, uint64_t *sum, uint64_t *count) const;
+
+    static double BucketUpperBound(int bucket);
+
+private:
+    // of one histogram, sharded so the threads of a busy db do not fight for one cache line
+    struct Buckets {
+        std::atomic<uint64_t> counts[BUCKET_NUM];
+        std::atomic<uint64_t> sum;
+    };
+
+    static const int SHARD_NUM = 8;
+
+    std::shared_ptr<rocksdb::Statistics> target_;
+    std::unique_ptr<Buckets[]> buckets_;
+};
+
+
+/*
+ * Collects the cumulative histograms of the registered rocksdbs on every scrape, one family a
+ * rocksdb histogram (rocksdb.db.get.micros -> engine_hist_db_get_micros) labeled by db. Rocksdbs
+ * added with the same name are summed.
+ */
+class CumulativeHistogramCollector : public prometheus::Collectable {
+public:
+    void Add(const std::string &name, const std::shared_ptr<CumulativeStatistics> &statistics);
+
+    std::vector<prometheus::MetricFamily> Collect() override;
+
+private:
+    std::mutex mutex_;
+    std::vector<std::pair<std::string, std::shared_ptr<CumulativeStatistics>>> statistics_;
+};
@@ -7,6 +7,7 @@
 #include <random>
 #include <thread>
 #include <algorithm>
+#include <string>
 #include <rocksdb/slice.h>
 
 #if defined(__GNUC__) && __GNUC__ >= 4
@@ -19,7 +20,7 @@
 
 
 enum WriteMode {
-    RANDOM, SEQUENTIAL, UNIQUE_RANDOM
+    RANDOM, SEQUENTIAL, UNIQUE_RANDOM, SKEWED
 };
 
 class Random;
@@ -132,35 +133,56 @@ public:
 };
 
 
+/*
+ * Numbers of the keys in [0, num), a writer thread takes the shard of it (shard, shard + shards,
+ * shard + 2 * shards...) for SEQUENTIAL and UNIQUE_RANDOM, so the threads never write the same key;
+ * SEQUENTIAL starts over and UNIQUE_RANDOM is reshuffled once every number of the shard is taken.
+ */
 class KeyGenerator {
 public:
-    KeyGenerator(WriteMode mode, uint64_t num)
+    KeyGenerator(WriteMode mode, uint64_t num, uint64_t shard = 0, uint64_t shards = 1)
             : rand_(std::chrono::steady_clock::now().time_since_epoch().count()),
-              mode_(mode), num_(num), next_(0) {
+              mode_(mode), num_(num), shard_(shard), shards_(shards), next_(0), max_log_(0) {
+        // SKEWED picks from [0, 2^max_log_) with exponential bias towards small keys
+        while (max_log_ < 63 && (uint64_t(1) << (max_log_ + 1)) <= num_) {
+            max_log_++;
+        }
         if (mode_ == UNIQUE_RANDOM) {
             // NOTE: if memory consumption of this approach becomes a concern,
             // we can either break it into pieces and only random shuffle a section
             // each time. Alternatively, use a bit map implementation
             // (https://reviews.facebook.net/differential/diff/54627/)
-            values_.resize(num_);
-            for (uint64_t i = 0; i < num_; ++i) {
-                values_[i] = i;
+            for (uint64_t i = shard_; i < num_; i += shards_) {
+                values_.push_back(i);
+            }
+            if (values_.empty()) {
+                values_.push_back(shard_ % num_);
             }
             std::shuffle(
                     values_.begin(), values_.end(),
-                    std::default_random_engine(static_cast<unsigned int>(10)));
+                    std::default_random_engine(static_cast<unsigned int>(10 + shard_)));
         }
     }
 
     uint64_t Next() {
         switch (mode_) {
             case SEQUENTIAL:
-                return next_++;
+                // stay below num, get_miss reads [num, 2 * num) as the keys never written
+                if (shard_ + shards_ * next_ >= num_) {
+                    next_ = 0;
+                }
+                return (shard_ + shards_ * next_++) % num_;
             case RANDOM:
                 return rand_.Next() % num_;
             case UNIQUE_RANDOM:
-                assert(next_ < num_);
+                if (next_ == values_.size()) {
+                    std::shuffle(values_.begin(), values_.end(), std::default_random_engine(
+                            static_cast<unsigned int>(rand_.Next())));
+                    next_ = 0;
+                }
                 return values_[next_++];
+            case SKEWED:
+                return rand_.Skewed(max_log_) % num_;
         }
         assert(false);
         return std::numeric_limits<uint64_t>::max();
@@ -170,11 +192,49 @@ private:
     Random64 rand_;
     WriteMode mode_;
     const uint64_t num_;
+    const uint64_t shard_;
+    const uint64_t shards_;
     uint64_t next_;
+    int max_log_;
     std::vector<uint64_t> values_;
 };
 
 
+/*
+ * Keys of the numbers of KeyGenerator: the decimal number, or with prefix_num > 0 a tenant
+ * prefix (number % prefix_num, zero padded to prefix_size digits) before it, so the keys of
+ * one tenant share the prefix a fixed prefix extractor of prefix_size takes.
+ */
+class KeyFormat {
+public:
+    KeyFormat(uint64_t prefix_num = 0, int prefix_size = 0)
+            : prefix_num_(prefix_num), prefix_size_(prefix_size) {}
+
+    bool HasPrefix() const { return prefix_num_ > 0; }
+
+    uint64_t PrefixNum() const { return prefix_num_; }
+
+    std::string Prefix(uint64_t tenant) const {
+        auto prefix = std::to_string(tenant);
+        if (prefix.size() < size_t(prefix_size_)) {
+            prefix.insert(0, prefix_size_ - prefix.size(), '0');
+        }
+        return prefix;
+    }
+
+    std::string Key(uint64_t num) const {
+        if (prefix_num_ == 0) {
+            return std::to_string(num);
+        }
+        return Prefix(num % prefix_num_) + std::to_string(num);
+    }
+
+private:
+    uint64_t prefix_num_;
+    int prefix_size_;
+};
+
+
 // Helper for quickly generating random data.
 class RandomGenerator {
 private:
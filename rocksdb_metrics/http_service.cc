@@ -0,0 +1,177 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <cctype>
+#include <sstream>
+#include "CivetServer.h"
+#include "http_service.hh"
+
+static const size_t MAX_REQUEST_BYTES = 1024 * 1024;
+
+const std::string *HttpRequest::Param(const std::string &name) const {
+    auto it = params.find(name);
+    return it == params.end() ? nullptr : &it->second;
+}
+
+static std::string UrlDecode(const std::string &str) {
+    std::string result;
+    for (size_t i = 0; i < str.size(); i++) {
+        if (str[i] == '+') {
+            result.push_back(' ');
+        } else if (str[i] == '%' && i + 2 < str.size() && isxdigit(str[i + 1]) && isxdigit(str[i + 2])) {
+            result.push_back(char(std::stoi(str.substr(i + 1, 2), nullptr, 16)));
+            i += 2;
+        } else {
+            result.push_back(str[i]);
+        }
+    }
+    return result;
+}
+
+// a=1&b=2
+static void ParseParams(const std::string &str, std::map<std::string, std::string> *params) {
+    std::istringstream in(str);
+    std::string pair;
+    while (std::getline(in, pair, '&')) {
+        if (pair.empty()) {
+            continue;
+        }
+        auto eq = pair.find('=');
+        if (eq == std::string::npos) {
+            (*params)[UrlDecode(pair)] = "";
+        } else {
+            (*params)[UrlDecode(pair.substr(0, eq))] = UrlDecode(pair.substr(eq + 1));
+        }
+    }
+}
+
+static const char *GetStatusText(int status) {
+    switch (status) {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 413:
+            return "Payload Too Large";
+        default:
+            return "Internal Server Error";
+    }
+}
+
+static void WriteResponse(mg_connection *conn, const HttpResponse &response) {
+    mg_printf(conn, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %lu\r\nConnection: close\r\n\r\n",
+              response.status, GetStatusText(response.status), response.content_type.c_str(),
+              (unsigned long) response.body.size());
+    mg_write(conn, response.body.data(), response.body.size());
+}
+
+
+// every path goes to HttpService::Dispatch, civetweb calls it from its worker threads
+class HttpService::CivetAdapter : public CivetHandler {
+public:
+    explicit CivetAdapter(HttpService *service) : service_(service) {
+    }
+
+    bool handleGet(CivetServer *, mg_connection *conn) override {
+        Handle(conn);
+        return true;
+    }
+
+    bool handlePost(CivetServer *, mg_connection *conn) override {
+        Handle(conn);
+        return true;
+    }
+
+private:
+    void Handle(mg_connection *conn) {
+        auto info = mg_get_request_info(conn);
+        HttpRequest request;
+        request.method = info->request_method;
+        request.path = info->local_uri;
+        if (info->query_string) {
+            ParseParams(info->query_string, &request.params);
+        }
+
+        if (info->content_length > (long long) MAX_REQUEST_BYTES) {
+            HttpResponse response;
+            response.status = 413;
+            response.body = "request too large\n";
+            WriteResponse(conn, response);
+            return;
+        }
+        std::string body;
+        char buf[4096];
+        int n;
+        while ((n = mg_read(conn, buf, sizeof(buf))) > 0) {
+            body.append(buf, n);
+            if (body.size() > MAX_REQUEST_BYTES) {
+                HttpResponse response;
+                response.status = 413;
+                response.body = "request too large\n";
+                WriteResponse(conn, response);
+                return;
+            }
+        }
+        ParseParams(body, &request.params);
+
+        WriteResponse(conn, service_->Dispatch(request));
+    }
+
+    HttpService *service_;
+};
+
+
+HttpService::HttpService(const std::string &host, int num_threads)
+        : host_(host), num_threads_(num_threads), adapter_(new CivetAdapter(this)) {
+}
+
+HttpService::~HttpService() {
+    Stop();
+}
+
+void HttpService::RegisterHandler(const std::string &path, Handler handler) {
+    std::lock_guard<std::mutex> lock(handlers_mutex_);
+    handlers_[path] = handler;
+}
+
+// throws CivetException when host can not be bound
+void HttpService::Start() {
+    server_.reset(new CivetServer({"listening_ports", host_,
+                                   "num_threads", std::to_string(num_threads_),
+                                   "request_timeout_ms", "2000"}));
+    server_->addHandler("/", adapter_.get());
+}
+
+void HttpService::Stop() {
+    if (server_) {
+        server_->removeHandler("/");
+        server_.reset();
+    }
+}
+
+HttpResponse HttpService::Dispatch(const HttpRequest &request) {
+    Handler handler;
+    {
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        auto it = handlers_.find(request.path);
+        if (it != handlers_.end()) {
+            handler = it->second;
+        }
+    }
+    if (!handler) {
+        HttpResponse response;
+        response.status = 404;
+        std::lock_guard<std::mutex> lock(handlers_mutex_);
+        response.body = "unknown path " + request.path + ", use:\n";
+        for (auto &pair : handlers_) {
+            response.body += "  " + pair.first + "\n";
+        }
+        return response;
+    }
+    return handler(request);
+}
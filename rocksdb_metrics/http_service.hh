@@ -0,0 +1,61 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class CivetServer;
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    // query string and urlencoded form body
+    std::map<std::string, std::string> params;
+
+    const std::string *Param(const std::string &name) const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "text/plain";
+    std::string body;
+};
+
+/*
+ * The admin endpoints on a civetweb server, the one the prometheus exposer is built on;
+ * a pool of num_threads serves the connections so a slow client holds only its own thread.
+ * host is "address:port" like the exposer's, bind a loopback address unless the endpoints
+ * are meant to be reachable from other hosts, there is no authentication.
+ */
+class HttpService {
+public:
+    typedef std::function<HttpResponse(const HttpRequest &)> Handler;
+
+    explicit HttpService(const std::string &host, int num_threads = 4);
+
+    ~HttpService();
+
+    void RegisterHandler(const std::string &path, Handler handler);
+
+    void Start();
+
+    void Stop();
+
+private:
+    class CivetAdapter;
+
+    HttpResponse Dispatch(const HttpRequest &request);
+
+    std::string host_;
+    int num_threads_;
+    std::unique_ptr<CivetAdapter> adapter_;
+    std::unique_ptr<CivetServer> server_;
+    std::mutex handlers_mutex_;
+    std::map<std::string, Handler> handlers_;
+};
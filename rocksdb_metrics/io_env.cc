@@ -0,0 +1,462 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <thread>
+#include "io_env.hh"
+#include "prometheus/counter.h"
+#include "prometheus/gauge.h"
+#include "prometheus/histogram.h"
+
+IoFileType GetIoFileType(const std::string &fname) {
+    auto pos = fname.find_last_of('/');
+    std::string base = pos == std::string::npos ? fname : fname.substr(pos + 1);
+    auto ends_with = [&base](const std::string &suffix) {
+        return base.size() >= suffix.size() &&
+               base.compare(base.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+
+    if (ends_with(".log")) {
+        return IO_FILE_WAL;
+    } else if (ends_with(".sst") || ends_with(".ldb")) {
+        return IO_FILE_SST;
+    } else if (base.compare(0, 9, "MANIFEST-") == 0) {
+        return IO_FILE_MANIFEST;
+    } else if (ends_with(".blob")) {
+        return IO_FILE_BLOB;
+    }
+    return IO_FILE_OTHER;
+}
+
+const char *GetIoFileTypeName(IoFileType type) {
+    switch (type) {
+        case IO_FILE_WAL:
+            return "wal";
+        case IO_FILE_SST:
+            return "sst";
+        case IO_FILE_MANIFEST:
+            return "manifest";
+        case IO_FILE_BLOB:
+            return "blob";
+        case IO_FILE_OTHER:
+            return "other";
+        default:
+            return "Invalid";
+    }
+}
+
+const char *GetIoOpTypeName(IoOpType op) {
+    switch (op) {
+        case IO_OP_READ:
+            return "read";
+        case IO_OP_WRITE:
+            return "write";
+        case IO_OP_SYNC:
+            return "sync";
+        default:
+            return "Invalid";
+    }
+}
+
+const char *GetIoKindName(IoKind kind) {
+    switch (kind) {
+        case IO_KIND_READ:
+            return "read";
+        case IO_KIND_PREAD:
+            return "pread";
+        case IO_KIND_APPEND:
+            return "append";
+        case IO_KIND_POSITIONED_APPEND:
+            return "positioned_append";
+        case IO_KIND_FSYNC:
+            return "fsync";
+        case IO_KIND_FDATASYNC:
+            return "fdatasync";
+        case IO_KIND_RANGE_SYNC:
+            return "range_sync";
+        default:
+            return "Invalid";
+    }
+}
+
+IoOpType GetIoOpType(IoKind kind) {
+    switch (kind) {
+        case IO_KIND_READ:
+        case IO_KIND_PREAD:
+            return IO_OP_READ;
+        case IO_KIND_APPEND:
+        case IO_KIND_POSITIONED_APPEND:
+            return IO_OP_WRITE;
+        default:
+            return IO_OP_SYNC;
+    }
+}
+
+
+IoStatistics::IoStatistics()
+        : BaseMetrics(),
+#define _io_init_counter_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildCounter() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .Register(*registry_) \
+    ),
+        _io_make_counter_family(_io_init_counter_familys)
+
+#define _io_init_gauge_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildGauge() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .Register(*registry_) \
+    ),
+        _io_make_gauge_family(_io_init_gauge_familys)
+
+#define _io_init_histogram_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildHistogram() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .BucketBoundaries(prometheus::Histogram::ExponentialBuckets(1, 2.0, 24)) \
+    .Register(*registry_) \
+    ),
+        _io_make_histogram_family(_io_init_histogram_familys)
+
+        dummy_() {
+}
+
+
+static uint64_t ElapsedMicros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+class ObservedSequentialFile : public rocksdb::FSSequentialFileWrapper {
+public:
+    ObservedSequentialFile(std::unique_ptr<rocksdb::FSSequentialFile> &&file,
+                           ObservedFileSystem *fs, IoFileType type)
+            : rocksdb::FSSequentialFileWrapper(file.get()), file_(std::move(file)), fs_(fs), type_(type) {}
+
+    rocksdb::IOStatus Read(size_t n, const rocksdb::IOOptions &options, rocksdb::Slice *result,
+                           char *scratch, rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->Read(n, options, result, scratch, dbg);
+        fs_->OnIo(type_, IO_KIND_READ, result->size(), ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus PositionedRead(uint64_t offset, size_t n, const rocksdb::IOOptions &options,
+                                     rocksdb::Slice *result, char *scratch,
+                                     rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->PositionedRead(offset, n, options, result, scratch, dbg);
+        fs_->OnIo(type_, IO_KIND_PREAD, result->size(), ElapsedMicros(start));
+        return s;
+    }
+
+private:
+    std::unique_ptr<rocksdb::FSSequentialFile> file_;
+    ObservedFileSystem *fs_;
+    IoFileType type_;
+};
+
+class ObservedRandomAccessFile : public rocksdb::FSRandomAccessFileWrapper {
+public:
+    ObservedRandomAccessFile(std::unique_ptr<rocksdb::FSRandomAccessFile> &&file,
+                             ObservedFileSystem *fs, IoFileType type)
+            : rocksdb::FSRandomAccessFileWrapper(file.get()), file_(std::move(file)), fs_(fs), type_(type) {}
+
+    rocksdb::IOStatus Read(uint64_t offset, size_t n, const rocksdb::IOOptions &options,
+                           rocksdb::Slice *result, char *scratch,
+                           rocksdb::IODebugContext *dbg) const override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->Read(offset, n, options, result, scratch, dbg);
+        fs_->OnIo(type_, IO_KIND_PREAD, result->size(), ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus MultiRead(rocksdb::FSReadRequest *reqs, size_t num_reqs,
+                                const rocksdb::IOOptions &options, rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->MultiRead(reqs, num_reqs, options, dbg);
+        size_t bytes = 0;
+        for (size_t i = 0; i < num_reqs; i++) {
+            bytes += reqs[i].result.size();
+        }
+        fs_->OnIo(type_, IO_KIND_PREAD, bytes, ElapsedMicros(start));
+        return s;
+    }
+
+private:
+    std::unique_ptr<rocksdb::FSRandomAccessFile> file_;
+    ObservedFileSystem *fs_;
+    IoFileType type_;
+};
+
+class ObservedWritableFile : public rocksdb::FSWritableFileWrapper {
+public:
+    ObservedWritableFile(std::unique_ptr<rocksdb::FSWritableFile> &&file,
+                         ObservedFileSystem *fs, IoFileType type)
+            : rocksdb::FSWritableFileWrapper(file.get()), file_(std::move(file)), fs_(fs), type_(type) {}
+
+    rocksdb::IOStatus Append(const rocksdb::Slice &data, const rocksdb::IOOptions &options,
+                             rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->Append(data, options, dbg);
+        fs_->OnIo(type_, IO_KIND_APPEND, data.size(), ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus Append(const rocksdb::Slice &data, const rocksdb::IOOptions &options,
+                             const rocksdb::DataVerificationInfo &verification_info,
+                             rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->Append(data, options, verification_info, dbg);
+        fs_->OnIo(type_, IO_KIND_APPEND, data.size(), ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus PositionedAppend(const rocksdb::Slice &data, uint64_t offset,
+                                       const rocksdb::IOOptions &options,
+                                       rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->PositionedAppend(data, offset, options, dbg);
+        fs_->OnIo(type_, IO_KIND_POSITIONED_APPEND, data.size(), ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus PositionedAppend(const rocksdb::Slice &data, uint64_t offset,
+                                       const rocksdb::IOOptions &options,
+                                       const rocksdb::DataVerificationInfo &verification_info,
+                                       rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->PositionedAppend(data, offset, options, verification_info, dbg);
+        fs_->OnIo(type_, IO_KIND_POSITIONED_APPEND, data.size(), ElapsedMicros(start));
+        return s;
+    }
+
+    // posix Sync is fdatasync
+    rocksdb::IOStatus Sync(const rocksdb::IOOptions &options, rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->Sync(options, dbg);
+        fs_->OnIo(type_, IO_KIND_FDATASYNC, 0, ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus Fsync(const rocksdb::IOOptions &options, rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->Fsync(options, dbg);
+        fs_->OnIo(type_, IO_KIND_FSYNC, 0, ElapsedMicros(start));
+        return s;
+    }
+
+    rocksdb::IOStatus RangeSync(uint64_t offset, uint64_t nbytes, const rocksdb::IOOptions &options,
+                                rocksdb::IODebugContext *dbg) override {
+        auto start = std::chrono::steady_clock::now();
+        auto s = file_->RangeSync(offset, nbytes, options, dbg);
+        fs_->OnIo(type_, IO_KIND_RANGE_SYNC, nbytes, ElapsedMicros(start));
+        return s;
+    }
+
+private:
+    std::unique_ptr<rocksdb::FSWritableFile> file_;
+    ObservedFileSystem *fs_;
+    IoFileType type_;
+};
+
+
+ObservedFileSystem::ObservedFileSystem(const std::shared_ptr<rocksdb::FileSystem> &base)
+        : rocksdb::FileSystemWrapper(base) {
+}
+
+rocksdb::IOStatus ObservedFileSystem::NewSequentialFile(const std::string &fname,
+                                                        const rocksdb::FileOptions &file_opts,
+                                                        std::unique_ptr<rocksdb::FSSequentialFile> *result,
+                                                        rocksdb::IODebugContext *dbg) {
+    std::unique_ptr<rocksdb::FSSequentialFile> file;
+    auto s = target()->NewSequentialFile(fname, file_opts, &file, dbg);
+    if (s.ok()) {
+        result->reset(new ObservedSequentialFile(std::move(file), this, GetIoFileType(fname)));
+    }
+    return s;
+}
+
+rocksdb::IOStatus ObservedFileSystem::NewRandomAccessFile(const std::string &fname,
+                                                          const rocksdb::FileOptions &file_opts,
+                                                          std::unique_ptr<rocksdb::FSRandomAccessFile> *result,
+                                                          rocksdb::IODebugContext *dbg) {
+    std::unique_ptr<rocksdb::FSRandomAccessFile> file;
+    auto s = target()->NewRandomAccessFile(fname, file_opts, &file, dbg);
+    if (s.ok()) {
+        result->reset(new ObservedRandomAccessFile(std::move(file), this, GetIoFileType(fname)));
+    }
+    return s;
+}
+
+rocksdb::IOStatus ObservedFileSystem::NewWritableFile(const std::string &fname,
+                                                      const rocksdb::FileOptions &file_opts,
+                                                      std::unique_ptr<rocksdb::FSWritableFile> *result,
+                                                      rocksdb::IODebugContext *dbg) {
+    auto s = target()->NewWritableFile(fname, file_opts, result, dbg);
+    if (s.ok()) {
+        WrapWritableFile(fname, result);
+    }
+    return s;
+}
+
+rocksdb::IOStatus ObservedFileSystem::ReopenWritableFile(const std::string &fname,
+                                                         const rocksdb::FileOptions &file_opts,
+                                                         std::unique_ptr<rocksdb::FSWritableFile> *result,
+                                                         rocksdb::IODebugContext *dbg) {
+    auto s = target()->ReopenWritableFile(fname, file_opts, result, dbg);
+    if (s.ok()) {
+        WrapWritableFile(fname, result);
+    }
+    return s;
+}
+
+rocksdb::IOStatus ObservedFileSystem::ReuseWritableFile(const std::string &fname,
+                                                        const std::string &old_fname,
+                                                        const rocksdb::FileOptions &file_opts,
+                                                        std::unique_ptr<rocksdb::FSWritableFile> *result,
+                                                        rocksdb::IODebugContext *dbg) {
+    auto s = target()->ReuseWritableFile(fname, old_fname, file_opts, result, dbg);
+    if (s.ok()) {
+        WrapWritableFile(fname, result);
+    }
+    return s;
+}
+
+void ObservedFileSystem::WrapWritableFile(const std::string &fname,
+                                          std::unique_ptr<rocksdb::FSWritableFile> *result) {
+    std::unique_ptr<rocksdb::FSWritableFile> file(std::move(*result));
+    result->reset(new ObservedWritableFile(std::move(file), this, GetIoFileType(fname)));
+}
+
+
+bool IoShapingOptions::Enabled() const {
+    if (read_latency_us || write_latency_us || sync_latency_us) {
+        return true;
+    }
+    if (spike_interval_ms && spike_duration_ms && spike_latency_us) {
+        return true;
+    }
+    for (int type = 0; type < IO_FILE_TYPE_MAX; type++) {
+        if (bandwidth[type]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+ShapingFileSystem::ShapingFileSystem(const std::shared_ptr<rocksdb::FileSystem> &base,
+                                     const IoShapingOptions &options,
+                                     IoStatistics &statistics)
+        : ObservedFileSystem(base), options_(options), start_(std::chrono::steady_clock::now()) {
+    for (int type = 0; type < IO_FILE_TYPE_MAX; type++) {
+        bandwidth_next_free_us_[type] = 0;
+        for (int op = 0; op < IO_OP_TYPE_MAX; op++) {
+            injected_delay_[type][op] = &statistics.STORE_IO_INJECTED_DELAY_VEC
+                    .WithLabelValues({GetIoFileTypeName(IoFileType(type)), GetIoOpTypeName(IoOpType(op))});
+            injected_ops_[type][op] = &statistics.STORE_IO_INJECTED_OPS_VEC
+                    .WithLabelValues({GetIoFileTypeName(IoFileType(type)), GetIoOpTypeName(IoOpType(op))});
+        }
+    }
+    latency_spike_ = &statistics.STORE_IO_LATENCY_SPIKE_VEC.WithLabelValues({Name()});
+}
+
+uint64_t ShapingFileSystem::NowMicros() const {
+    return ElapsedMicros(start_);
+}
+
+uint64_t ShapingFileSystem::DrawLatency(uint64_t mean_us) {
+    if (mean_us == 0) {
+        return 0;
+    }
+    static thread_local std::mt19937_64 rnd(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    if (options_.latency_distribution == "uniform") {
+        return std::uniform_int_distribution<uint64_t>(0, 2 * mean_us - 1)(rnd);
+    } else if (options_.latency_distribution == "exponential") {
+        return uint64_t(std::exponential_distribution<double>(1.0 / mean_us)(rnd));
+    }
+    return mean_us;
+}
+
+uint64_t ShapingFileSystem::BandwidthWait(IoFileType type, size_t bytes, uint64_t now_us) {
+    auto bandwidth = options_.bandwidth[type];
+    if (bandwidth == 0 || bytes == 0) {
+        return 0;
+    }
+    uint64_t cost_us = bytes * 1000000 / bandwidth;
+    std::lock_guard<std::mutex> lock(bandwidth_mutex_[type]);
+    auto &next_free = bandwidth_next_free_us_[type];
+    next_free = std::max(next_free, now_us) + cost_us;
+    return next_free - now_us;
+}
+
+void ShapingFileSystem::OnIo(IoFileType type, IoKind kind, size_t bytes, uint64_t micros) {
+    auto op = GetIoOpType(kind);
+    auto now_us = NowMicros();
+    uint64_t delay_us = 0;
+    switch (op) {
+        case IO_OP_READ:
+            delay_us += DrawLatency(options_.read_latency_us);
+            break;
+        case IO_OP_WRITE:
+            delay_us += DrawLatency(options_.write_latency_us);
+            break;
+        case IO_OP_SYNC:
+            delay_us += DrawLatency(options_.sync_latency_us);
+            break;
+        default:
+            break;
+    }
+
+    if (options_.spike_interval_ms && options_.spike_latency_us) {
+        // the first spike comes after one full interval, the run starts with a steady baseline
+        auto now_ms = now_us / 1000;
+        bool spike = now_ms >= options_.spike_interval_ms
+                     && now_ms % options_.spike_interval_ms < options_.spike_duration_ms;
+        latency_spike_->Set(spike ? 1 : 0);
+        if (spike) {
+            delay_us += options_.spike_latency_us;
+        }
+    }
+
+    // range sync bytes are already charged when appended
+    if (op != IO_OP_SYNC) {
+        delay_us += BandwidthWait(type, bytes, now_us);
+    }
+    if (delay_us == 0) {
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+    injected_delay_[type][op]->Increment(delay_us);
+    injected_ops_[type][op]->Increment();
+}
+
+
+AccountingFileSystem::AccountingFileSystem(const std::shared_ptr<rocksdb::FileSystem> &base,
+                                           IoStatistics &statistics)
+        : ObservedFileSystem(base) {
+    for (int type = 0; type < IO_FILE_TYPE_MAX; type++) {
+        for (int kind = 0; kind < IO_KIND_MAX; kind++) {
+            auto type_name = GetIoFileTypeName(IoFileType(type));
+            auto kind_name = GetIoKindName(IoKind(kind));
+            bytes_[type][kind] = &statistics.STORE_IO_BYTES_VEC.WithLabelValues({type_name, kind_name});
+            ops_[type][kind] = &statistics.STORE_IO_OPS_VEC.WithLabelValues({type_name, kind_name});
+            latency_[type][kind] = &statistics.STORE_IO_LATENCY_VEC.WithLabelValues({type_name, kind_name});
+        }
+    }
+}
+
+void AccountingFileSystem::OnIo(IoFileType type, IoKind kind, size_t bytes, uint64_t micros) {
+    bytes_[type][kind]->Increment(bytes);
+    ops_[type][kind]->Increment();
+    latency_[type][kind]->Observe(micros);
+}
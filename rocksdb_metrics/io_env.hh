@@ -0,0 +1,187 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <mutex>
+#include <chrono>
+#include <rocksdb/env.h>
+#include <rocksdb/file_system.h>
+#include "metrics.hh"
+
+enum IoFileType {
+    IO_FILE_WAL, IO_FILE_SST, IO_FILE_MANIFEST, IO_FILE_BLOB, IO_FILE_OTHER, IO_FILE_TYPE_MAX
+};
+
+// the class of an io, shaping latency is configured by it
+enum IoOpType {
+    IO_OP_READ, IO_OP_WRITE, IO_OP_SYNC, IO_OP_TYPE_MAX
+};
+
+// the file system call of an io
+enum IoKind {
+    IO_KIND_READ, IO_KIND_PREAD, IO_KIND_APPEND, IO_KIND_POSITIONED_APPEND,
+    IO_KIND_FSYNC, IO_KIND_FDATASYNC, IO_KIND_RANGE_SYNC, IO_KIND_MAX
+};
+
+// classify a rocksdb file by its name: 000012.log, 000013.sst, MANIFEST-000005, 000014.blob
+IoFileType GetIoFileType(const std::string &fname);
+
+const char *GetIoFileTypeName(IoFileType type);
+
+const char *GetIoOpTypeName(IoOpType op);
+
+const char *GetIoKindName(IoKind kind);
+
+IoOpType GetIoOpType(IoKind kind);
+
+
+class IoStatistics : public BaseMetrics {
+public:
+    IoStatistics();
+
+#define _io_make_counter_family(val) \
+    val(STORE_IO_INJECTED_DELAY_VEC,    "engine_io_injected_delay_micros",  "Delay injected into io by the shaping file system", "type", "op") \
+    val(STORE_IO_INJECTED_OPS_VEC,      "engine_io_injected_delay_ops",     "Number of io delayed by the shaping file system",   "type", "op") \
+    val(STORE_IO_BYTES_VEC,             "engine_io_bytes",                  "Bytes read or written by rocksdb per file type",    "type", "op") \
+    val(STORE_IO_OPS_VEC,               "engine_io_ops",                    "Number of file system calls by rocksdb per file type", "type", "op") \
+
+
+#define _io_make_gauge_family(val) \
+    val(STORE_IO_LATENCY_SPIKE_VEC,     "engine_io_latency_spike",          "1 while the shaping file system injects a latency spike", "fs") \
+
+
+#define _io_make_histogram_family(val) \
+    val(STORE_IO_LATENCY_VEC,           "engine_io_latency_micros",         "Latency of file system calls by rocksdb per file type", "type", "op") \
+
+
+private:
+    friend class ShapingFileSystem;
+    friend class AccountingFileSystem;
+
+#define _io_make_counter_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Counter>& param;
+    _io_make_counter_family(_io_make_counter_params)
+#define _io_make_gauge_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Gauge>& param;
+    _io_make_gauge_family(_io_make_gauge_params)
+#define _io_make_histogram_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Histogram>& param;
+    _io_make_histogram_family(_io_make_histogram_params)
+
+    int dummy_;
+};
+
+
+/*
+ * Wraps a FileSystem, every file opened through it reports each read/write/sync to OnIo
+ * after the call returns from the base file system.
+ */
+class ObservedFileSystem : public rocksdb::FileSystemWrapper {
+public:
+    explicit ObservedFileSystem(const std::shared_ptr<rocksdb::FileSystem> &base);
+
+    rocksdb::IOStatus NewSequentialFile(const std::string &fname,
+                                        const rocksdb::FileOptions &file_opts,
+                                        std::unique_ptr<rocksdb::FSSequentialFile> *result,
+                                        rocksdb::IODebugContext *dbg) override;
+
+    rocksdb::IOStatus NewRandomAccessFile(const std::string &fname,
+                                          const rocksdb::FileOptions &file_opts,
+                                          std::unique_ptr<rocksdb::FSRandomAccessFile> *result,
+                                          rocksdb::IODebugContext *dbg) override;
+
+    rocksdb::IOStatus NewWritableFile(const std::string &fname,
+                                      const rocksdb::FileOptions &file_opts,
+                                      std::unique_ptr<rocksdb::FSWritableFile> *result,
+                                      rocksdb::IODebugContext *dbg) override;
+
+    rocksdb::IOStatus ReopenWritableFile(const std::string &fname,
+                                         const rocksdb::FileOptions &file_opts,
+                                         std::unique_ptr<rocksdb::FSWritableFile> *result,
+                                         rocksdb::IODebugContext *dbg) override;
+
+    rocksdb::IOStatus ReuseWritableFile(const std::string &fname,
+                                        const std::string &old_fname,
+                                        const rocksdb::FileOptions &file_opts,
+                                        std::unique_ptr<rocksdb::FSWritableFile> *result,
+                                        rocksdb::IODebugContext *dbg) override;
+
+    // micros is the time the call spent in the base file system
+    virtual void OnIo(IoFileType type, IoKind kind, size_t bytes, uint64_t micros) = 0;
+
+private:
+    void WrapWritableFile(const std::string &fname, std::unique_ptr<rocksdb::FSWritableFile> *result);
+};
+
+
+struct IoShapingOptions {
+    // fixed: always the mean; uniform: [0, 2 * mean); exponential: with the mean
+    std::string latency_distribution = "fixed";
+    uint64_t read_latency_us = 0;
+    uint64_t write_latency_us = 0;
+    uint64_t sync_latency_us = 0;
+    // bytes per second of read + write for every file type, 0 means unlimited
+    uint64_t bandwidth[IO_FILE_TYPE_MAX] = {0};
+    // every spike_interval_ms from the end of the first, the first spike_duration_ms add
+    // spike_latency_us to every io
+    uint64_t spike_interval_ms = 0;
+    uint64_t spike_duration_ms = 0;
+    uint64_t spike_latency_us = 0;
+
+    bool Enabled() const;
+};
+
+
+/*
+ * Every read/write/sync first goes to the base file system and then sleeps for the latency
+ * drawn from the distribution, plus the bandwidth cap wait of the file type and the latency
+ * spike if one is in progress.
+ */
+class ShapingFileSystem : public ObservedFileSystem {
+public:
+    ShapingFileSystem(const std::shared_ptr<rocksdb::FileSystem> &base,
+                      const IoShapingOptions &options,
+                      IoStatistics &statistics);
+
+    const char *Name() const override { return "ShapingFileSystem"; }
+
+    void OnIo(IoFileType type, IoKind kind, size_t bytes, uint64_t micros) override;
+
+private:
+    uint64_t NowMicros() const;
+
+    uint64_t DrawLatency(uint64_t mean_us);
+
+    uint64_t BandwidthWait(IoFileType type, size_t bytes, uint64_t now_us);
+
+    IoShapingOptions options_;
+    std::chrono::steady_clock::time_point start_;
+    // virtual clock of every file type, io of the type is served at bandwidth after it
+    std::mutex bandwidth_mutex_[IO_FILE_TYPE_MAX];
+    uint64_t bandwidth_next_free_us_[IO_FILE_TYPE_MAX];
+    prometheus::Counter *injected_delay_[IO_FILE_TYPE_MAX][IO_OP_TYPE_MAX];
+    prometheus::Counter *injected_ops_[IO_FILE_TYPE_MAX][IO_OP_TYPE_MAX];
+    prometheus::Gauge *latency_spike_;
+};
+
+
+/*
+ * Records bytes, calls and latency of every file system call by file type and call kind,
+ * stacked above the shaping file system it sees the latency rocksdb sees.
+ */
+class AccountingFileSystem : public ObservedFileSystem {
+public:
+    AccountingFileSystem(const std::shared_ptr<rocksdb::FileSystem> &base,
+                         IoStatistics &statistics);
+
+    const char *Name() const override { return "AccountingFileSystem"; }
+
+    void OnIo(IoFileType type, IoKind kind, size_t bytes, uint64_t micros) override;
+
+private:
+    prometheus::Counter *bytes_[IO_FILE_TYPE_MAX][IO_KIND_MAX];
+    prometheus::Counter *ops_[IO_FILE_TYPE_MAX][IO_KIND_MAX];
+    prometheus::Histogram *latency_[IO_FILE_TYPE_MAX][IO_KIND_MAX];
+};
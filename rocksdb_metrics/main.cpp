@@ -1,24 +1,52 @@
 #include <iostream>
+#include <algorithm>
+#include <sstream>
 #include <random>
 #include <chrono>
 #include <thread>
+#include <functional>
+#include <unordered_map>
 
+#include <fstream>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include <rocksdb/db.h>
+#include <rocksdb/env.h>
 #include <rocksdb/options.h>
 #include <rocksdb/table.h>
 #include <rocksdb/filter_policy.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/rate_limiter.h>
+#include <rocksdb/cache.h>
+#include <rocksdb/write_buffer_manager.h>
+#include <rocksdb/utilities/transaction_db.h>
+#include <rocksdb/utilities/optimistic_transaction_db.h>
+#include <rocksdb/utilities/db_ttl.h>
 
 #include "metrics.hh"
 #include "rocksdb_metrics.hh"
 #include "system_metrics.hh"
 #include "benchmark.hh"
+#include "io_env.hh"
+#include "rate_limiter_metrics.hh"
+#include "options_config.hh"
+#include "http_service.hh"
+#include "cumulative_statistics.hh"
+#include "scrape_collector.hh"
+#include "metrics_scheduler.hh"
+#include "trace_recorder.hh"
+#include "slow_ops.hh"
+#include "tsdb_recorder.hh"
+#include "thread_status_metrics.hh"
 
 
 #include <gflags/gflags.h>
 
+using GFLAGS_NAMESPACE::GetCommandLineFlagInfoOrDie;
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::RegisterFlagValidator;
 using GFLAGS_NAMESPACE::SetUsageMessage;
@@ -28,14 +56,43 @@ DEFINE_string(
         "put,"
         "batch,",
         "\tput    -- use db.put to test\n"
-        "\tbatch  -- use writebatch to test\n");
+        "\tbatch  -- use writebatch to test\n"
+        "\ttxn    -- use read-modify-write transactions to test, needs --txn\n"
+        "\tget    -- use db.get of written keys to test\n"
+        "\tget_miss -- use db.get of never written keys to test, measures the filters\n"
+        "\tseek   -- use iterator seek and next of a key prefix (--key_prefix_num) or key to test\n"
+        "\tcomma separated benchmarks run together, e.g. put,get_miss\n");
 DEFINE_int32(threads, 1, "Number of threads");
 DEFINE_int64(nums, 10000, "Number of key nums to write");
 DEFINE_int32(value_size, 100, "the value size");
 DEFINE_int32(prometheus_port, 8080, "prometheus port");
+DEFINE_int32(admin_port, 0, "http port of the admin endpoints /set_options and /set_db_options, 0 disable");
+DEFINE_string(admin_bind, "127.0.0.1", "address the admin port binds, the endpoints have no authentication, 0.0.0.0 to reach them from other hosts");
+DEFINE_bool(collect_on_scrape, false, "collect the rocksdb and system metrics when prometheus scrapes, "
+                                      "instead of every --metrics_interval_ms");
+DEFINE_int32(scrape_min_interval_ms, 1000, "if collect on scrape, scrapes within the interval get the last result (ms)");
+DEFINE_int32(metrics_threads, 4, "threads sampling the metrics of the rocksdbs concurrently");
+DEFINE_int32(metrics_interval_ms, 2000, "every rocksdb is sampled once an interval, if not collect on scrape (ms)");
+DEFINE_int32(trace_events, 0, "flush/compaction begin/end and stall changes kept for the trace, e.g. 65536, 0 disable");
+DEFINE_string(trace_file, "", "if trace events, the chrome trace json is written to it at exit (ctrl-c), empty disable");
+DEFINE_int64(slow_op_threshold_us, 10000, "benchmark ops slower than this are captured with the engine state (us)");
+DEFINE_int32(slow_ops_per_thread, 0, "the slowest ops kept by every benchmark thread, e.g. 16, 0 disable");
+DEFINE_string(slow_ops_file, "", "if slow ops, the slow ops json is written to it at exit (ctrl-c), empty disable");
+DEFINE_string(tsdb_file, "", "every metric is also recorded to this local file, read it with trocksdb_dump, empty disable");
+DEFINE_int32(tsdb_interval_ms, 1000, "if tsdb file, the metrics are recorded once an interval (ms)");
+DEFINE_int32(tsdb_chunk_seconds, 60, "if tsdb file, a series is written out every chunk, a killed run loses "
+                                     "up to it; shorter makes the file bigger (s)");
 DEFINE_int32(rocksdb_num, 1, "rocksdb's nums for test");
 DEFINE_int32(rocksdb_columns, 1, "every rocksdb's column familys");
 DEFINE_int32(batch_num, 1, "if use batch to test, it's batch nums");
+DEFINE_string(env, "default", "rocksdb env: default/mem, mem keeps all files in memory (cpu-bound, no disk io)");
+DEFINE_string(write_mode, "random", "key order of put/batch: random/sequential/unique_random/skewed");
+DEFINE_string(txn, "none", "open rocksdb as transaction db: none/pessimistic/optimistic");
+DEFINE_int32(txn_keys, 4, "if use txn to test, keys read-modify-written in one transaction");
+DEFINE_int64(txn_lock_timeout, 1000, "pessimistic transaction lock timeout (ms)");
+DEFINE_bool(txn_deadlock_detect, true, "pessimistic transaction deadlock detect or not");
+DEFINE_string(ttl_seconds, "", "open rocksdb as ttl db, ttl of every column family (s), "
+                               "e.g. 3600,600; the last one is used for the rest column families");
 
 
 DEFINE_bool(sync, true, "rockdb sync or not");
@@ -44,12 +101,78 @@ DEFINE_bool(disable_wal, false, "disable rockdb wal or not");
 DEFINE_bool(dynamic_level_bytes, false, " level compaction dynamic level bytes");
 DEFINE_int32(max_subcompactions, 10, "options max subcompactions");
 DEFINE_int32(max_background_compactions, 10, "options max background compactions");
+DEFINE_bool(thread_tracking, false, "options enable thread tracking, the busy fraction of the flush/compaction threads");
+DEFINE_int32(thread_sample_interval_ms, 100, "if thread tracking, the threads of the pools are sampled every interval (ms)");
 DEFINE_int32(write_buffer_size, 128, "options write buffer size (MB)");
 DEFINE_int32(max_bytes_for_level_base, 512, "options max bytes for level base (MB)");
 DEFINE_int32(level0_file_num_compaction_trigger, 4, "options level0 file num compaction trigger");
 DEFINE_int32(level0_slowdown_writes_trigger, 20, "options level0 slowdown writes trigger");
 DEFINE_int32(level0_stop_writes_trigger,     36, "options level0 stop     writes trigger");
 
+DEFINE_bool(enable_blob_files, false, "separate large values into blob files (key-value separation)");
+DEFINE_int32(min_blob_size, 4096, "options min blob size, smaller values stay in sst (bytes)");
+DEFINE_int32(blob_file_size, 256, "options blob file size (MB)");
+DEFINE_bool(enable_blob_gc, true, "relocate valid blobs out of old blob files during compaction");
+DEFINE_double(blob_gc_age_cutoff, 0.25, "options blob garbage collection age cutoff (oldest fraction of blob files)");
+DEFINE_double(blob_gc_force_threshold, 1.0, "options blob garbage collection force threshold (garbage ratio)");
+DEFINE_string(compaction_style, "level", "options compaction style: level/universal/fifo");
+DEFINE_int32(universal_size_ratio, 1, "universal compaction size ratio (%), a run is merged if the next is not this bigger");
+DEFINE_int32(universal_min_merge_width, 2, "universal compaction min number of sorted runs merged at once");
+DEFINE_int32(universal_max_size_amplification_percent, 200, "universal compaction max size amplification (%), "
+                                                            "above it every sorted run is merged");
+DEFINE_int32(fifo_max_table_files_size_mb, 1024, "fifo compaction drops the oldest files above this size (MB)");
+DEFINE_int64(fifo_ttl_seconds, 0, "fifo compaction drops files older than this (s), 0 disable");
+DEFINE_bool(fifo_allow_compaction, false, "fifo compaction merges small level0 files");
+DEFINE_string(compression_per_level, "none", "options compression of each level: none/snappy/zlib/lz4/lz4hc/zstd, "
+                                            "comma separated from level0, the last one is used by the deeper levels");
+DEFINE_string(bottommost_compression, "disable", "options compression of the bottommost level, "
+                                                 "disable follows compression_per_level");
+DEFINE_int32(compression_max_dict_bytes, 0, "options compression dictionary size of each sst (bytes), 0 disable");
+DEFINE_int32(compression_zstd_max_train_bytes, 0, "options zstd dictionary training samples size (bytes), "
+                                                  "0 uses the samples as the dictionary");
+DEFINE_int32(compression_parallel_threads, 1, "options threads compressing the blocks of one sst");
+DEFINE_string(filter_policy, "bloom", "options filter of every sst: none/bloom/ribbon/block, "
+                                     "block is the legacy block-based bloom filter");
+DEFINE_double(bloom_bits_per_key, 10, "options filter bits per key, ribbon takes the bloom equivalent bits");
+DEFINE_bool(partition_filters, false, "options partition the filter and index of every sst, "
+                                      "only the top level partitions stay in the block cache");
+DEFINE_bool(whole_key_filtering, true, "options add whole keys to the filters");
+DEFINE_bool(optimize_filters_for_hits, false, "options no filters on the last level, for gets mostly hit");
+DEFINE_int32(prefix_size, 0, "options fixed prefix extractor length, 0 disable, the prefix bloom/hash index are built on it");
+DEFINE_int64(key_prefix_num, 0, "keys start with one of these many tenant prefixes of --prefix_size digits, 0 plain keys");
+DEFINE_string(index_type, "binary", "options index of block based ssts: binary/hash/two_level, hash needs --prefix_size");
+DEFINE_double(memtable_prefix_bloom_size_ratio, 0, "options memtable prefix bloom size over write_buffer_size, "
+                                                   "0 disable, needs --prefix_size");
+DEFINE_string(table_format, "block_based", "sst format: block_based/plain, plain is mmap read (--env=default only) "
+                                           "with a prefix hash index, no block cache and no compression");
+DEFINE_int32(perf_sample_every, 0, "time the stages (wal, memtable, write delay, block read...) of 1 in N "
+                                     "benchmark ops with the perf context, 0 disable");
+DEFINE_int32(seek_nexts, 10, "if use seek to test, keys read by next after every seek");
+DEFINE_int64(periodic_compaction_seconds, -1, "options periodic compaction seconds, -1 use rocksdb default");
+
+DEFINE_string(config, "", "rocksdb and column family options file: a kv yaml config (conf/rocksdb.yml) "
+                          "or a rocksdb OPTIONS file, the options flags given override it");
+DEFINE_string(config_section, "rocksdb", "section of the yaml config used: rocksdb/raftdb");
+DEFINE_int32(shared_cache_mb, 0, "one block cache shared by every rocksdb and column family (MB), "
+                                 "0 gives every column family its own 1GB cache");
+DEFINE_string(cache_type, "lru", "type of the shared block cache: lru/clock");
+DEFINE_int32(cache_shard_bits, -1, "shard bits of the shared block cache, -1 picks by capacity");
+DEFINE_int32(write_buffer_manager_mb, 0, "memtables limit of every rocksdb together (MB), charged to the "
+                                         "shared block cache if there is one, 0 disable");
+DEFINE_int32(rate_limit_mb, 0, "options rate limiter of flush and compaction writes (MB/s), 0 disable");
+DEFINE_bool(rate_limit_auto_tune, false, "auto tune the rate limiter, --rate_limit_mb is the upper bound");
+DEFINE_bool(io_accounting, false, "record bytes, calls and latency of file system calls per file type");
+DEFINE_string(io_latency_distribution, "fixed", "injected io latency distribution: fixed/uniform/exponential");
+DEFINE_int64(io_read_latency_us, 0, "injected latency of every read (us), 0 disable");
+DEFINE_int64(io_write_latency_us, 0, "injected latency of every write (us), 0 disable");
+DEFINE_int64(io_sync_latency_us, 0, "injected latency of every fsync/fdatasync/range sync (us), 0 disable");
+DEFINE_int32(io_wal_bandwidth_mb, 0, "bandwidth cap of wal files (MB/s), 0 unlimited");
+DEFINE_int32(io_sst_bandwidth_mb, 0, "bandwidth cap of sst files (MB/s), 0 unlimited");
+DEFINE_int32(io_manifest_bandwidth_mb, 0, "bandwidth cap of manifest files (MB/s), 0 unlimited");
+DEFINE_int64(io_spike_interval_ms, 0, "inject a latency spike every interval (ms), 0 disable");
+DEFINE_int64(io_spike_duration_ms, 1000, "duration of every latency spike (ms)");
+DEFINE_int64(io_spike_latency_us, 0, "latency added to every io during a spike (us)");
+
 /*
  * trocksdb --benchmarks=put --nums=100000000 --sync=false
  * --disable_wal=false --prometheus_port=8080 --value_size=1000
@@ -60,8 +183,610 @@ DEFINE_int32(level0_stop_writes_trigger,     36, "options level0 stop     writes
  * --level0_slowdown_writes_trigger=20
  * --level0_stop_writes_trigger=36
  * --wal_bytes_per_sync=0
+ *
+ * large value (16KB ~ 256KB) with key-value separation:
+ * trocksdb --benchmarks=put --value_size=65536 --enable_blob_files=true
+ * --min_blob_size=4096 --blob_file_size=256 --enable_blob_gc=true
+ *
+ * multi-key transactions over skewed keys:
+ * trocksdb --benchmarks=txn --txn=pessimistic --txn_keys=4 --threads=16
+ * --txn_lock_timeout=1000 --txn_deadlock_detect=true
+ * rocksdb_txn_lock_wait_micros is the GetForUpdate time of every txn, --perf_sample_every=100
+ * adds the stages of rocksdb_perf_stage_micros{type="txn"}
+ *
+ * ttl db with a continuously turning over live set (every key is written once):
+ * trocksdb --benchmarks=put --write_mode=sequential --nums=1000000000
+ * --ttl_seconds=600 --periodic_compaction_seconds=3600
+ * the expected live bytes is increase(rocksdb_operator_bytes[600s]), compare it with
+ * engine_size_bytes and engine_compaction_dropped{type="dropped_bytes"} (an upper bound, deletes count too)
+ *
+ * slow disk with periodic spikes, watch L0 pile up until the write stop:
+ * trocksdb --benchmarks=put --io_latency_distribution=exponential
+ * --io_write_latency_us=200 --io_sync_latency_us=2000 --io_sst_bandwidth_mb=50
+ * --io_spike_interval_ms=30000 --io_spike_duration_ms=5000 --io_spike_latency_us=50000
+ * the injected delay is engine_io_injected_delay_micros{type,op}, the spike window is
+ * engine_io_latency_spike, compare them with engine_stall_conditions_changed
+ *
+ * where the io goes, every file system call is wrapped and timed so leave it off for the baseline:
+ * trocksdb --benchmarks=put --io_accounting=true
+ * engine_io_bytes/engine_io_ops/engine_io_latency_micros{type="wal|sst|manifest|blob|other",
+ * op="read|pread|append|positioned_append|fsync|fdatasync|range_sync"}, e.g. compare
+ * op="range_sync" with --wal_bytes_per_sync=0 and --wal_bytes_per_sync=512
+ *
+ * foreground latency with flush/compaction writes limited, run once with
+ * --rate_limit_mb=0 at the same --threads and compare rocksdb_operator_time p99:
+ * trocksdb --benchmarks=put --rate_limit_mb=100 --rate_limit_auto_tune=true
+ * the limiter is engine_rate_limiter_bytes/requests/wait_micros/pending_requests{pri}
+ * and engine_rate_limiter_bytes_per_second
+ *
+ * the options of a production node, the column families are the ones of the config
+ * (default/write/lock) unless --rocksdb_columns is given, options flags given override it:
+ * trocksdb --benchmarks=put --config=../conf/rocksdb.yml --config_section=rocksdb
+ * --max_subcompactions=4
+ *
+ * tune options of the running dbs, every change is engine_option_changed_timestamp_seconds
+ * {db,cf,option} for grafana annotations and engine_option_value{db,cf,option} for the numeric
+ * ones (db= is the db label, e.g. rocks0, or the index of --rocksdb_num, cf= the column family
+ * name, all of them when not given); the admin port binds 127.0.0.1 unless --admin_bind=0.0.0.0:
+ * trocksdb --benchmarks=put --admin_port=8081
+ * curl 'http://127.0.0.1:8081/set_options?db=rocks0&cf=default&level0_slowdown_writes_trigger=30'
+ * curl 'http://127.0.0.1:8081/set_db_options?max_background_compactions=8'
+ *
+ * a memory capped node, every instance and column family in one 4GB cache with the
+ * memtables charged to it, see engine_memory_budget_bytes{type}; what the cache holds is
+ * engine_block_cache_entries{role="data-block|index-block|filter-block|write-buffer...",type="bytes"}
+ * and engine_block_cache_bytes{type="pinned_usage|capacity"}:
+ * trocksdb --benchmarks=put --rocksdb_num=4 --rocksdb_columns=4 --shared_cache_mb=4096
+ * --cache_type=lru --cache_shard_bits=6 --write_buffer_manager_mb=1024
+ *
+ * time series tier, compare engine_compaction_flow_bytes (write-amp) and rocksdb_operator_time
+ * with the level style, the shape is engine_num_sorted_runs and engine_size_amplification:
+ * trocksdb --benchmarks=put --write_mode=sequential --compaction_style=universal
+ * --universal_size_ratio=1 --universal_max_size_amplification_percent=200
+ * trocksdb --benchmarks=put --write_mode=sequential --compaction_style=fifo
+ * --fifo_max_table_files_size_mb=10240 --fifo_ttl_seconds=86400
+ *
+ * lz4 on the upper levels and zstd with a dictionary on the bottommost, the cost is
+ * engine_compaction_level{type="cpu_micros"} and engine_compression_nanos_per_byte,
+ * the benefit is engine_compression_bytes{type="saved"} of each level:
+ * trocksdb --benchmarks=put --compression_per_level=none,none,lz4 --bottommost_compression=zstd
+ * --compression_max_dict_bytes=16384 --compression_zstd_max_train_bytes=1638400
+ *
+ * filter memory vs io, run a put first and compare engine_filter_false_positive_rate and
+ * engine_table_meta_size_bytes{type="filter"} with the bits per key and filter policies:
+ * trocksdb --benchmarks=put,get_miss --nums=10000000 --filter_policy=bloom --bloom_bits_per_key=10
+ * trocksdb --benchmarks=put,get_miss --nums=10000000 --filter_policy=ribbon --bloom_bits_per_key=10
+ * --partition_filters=true
+ * the block based filter (--filter_policy=block) has no false positive rate, compare its
+ * engine_bloom_efficiency{type="bloom_filter_useful"} instead
+ *
+ * tenant + id keys, lookups and seeks of one tenant with the prefix bloom and the hash index,
+ * compare rocksdb_operator_time{type="get"/"seek"} and engine_bloom_efficiency{type="bloom_filter_prefix_useful"}
+ * with --index_type=binary and with --table_format=plain:
+ * trocksdb --benchmarks=put,get,seek --key_prefix_num=10000 --prefix_size=8 --index_type=hash
+ * --memtable_prefix_bloom_size_ratio=0.1 --seek_nexts=10
+ *
+ * metrics as fresh as the scrape and no cost while nobody scrapes, the rocksdbs are only
+ * walked when /metrics is requested, scrapers within 1s share one collect:
+ * trocksdb --benchmarks=put --rocksdb_num=8 --collect_on_scrape=true --scrape_min_interval_ms=1000
+ *
+ * instances side by side, every rocksdb is labeled db="rocks0".."rocks7" (the dir under
+ * rocksdb_data) and all of them are sampled together every interval by 4 threads:
+ * trocksdb --benchmarks=put --rocksdb_num=8 --metrics_threads=4 --metrics_interval_ms=2000
+ *
+ * amplification per level, engine_level_stats{level,type="write_amp|read_bytes|write_bytes|comp_seconds
+ * |num_files|score"} is the compaction stats table of the LOG, engine_amplification{type="write|space"}
+ * the whole db, compare them with --dynamic_level_bytes=true and --dynamic_level_bytes=false:
+ * trocksdb --benchmarks=put --write_mode=unique_random --dynamic_level_bytes=true
+ *
+ * where the time of a put/get goes when rocksdb_operator_time p99 jumps, 1 in 100 ops is timed
+ * by stage into rocksdb_perf_stage_micros{type,stage="write_wal_time|write_memtable_time|
+ * write_delay_time|write_thread_wait_nanos|db_mutex_lock_nanos|block_read_time|io_fsync_nanos..."}:
+ * trocksdb --benchmarks=put,get --perf_sample_every=100
+ *
+ * flush/compaction timeline with the stalls, open it in chrome://tracing or ui.perfetto.dev, the
+ * jobs are on their background threads of every rocksdb and the stall state (0 normal, 1 delayed,
+ * 2 stopped) of every column family is a counter track; at exit (ctrl-c) or from the admin port:
+ * trocksdb --benchmarks=put --trace_events=65536 --trace_file=trocksdb_trace.json --admin_port=8081
+ * curl -o trace.json 'http://127.0.0.1:8081/trace'
+ *
+ * are the background threads the bottleneck, engine_thread_busy_fraction{pool="low"} near 1 with
+ * engine_background_jobs{type="compaction_pending"} > 0 says yes, then try more threads:
+ * trocksdb --benchmarks=put --max_background_compactions=4 --thread_tracking=true --thread_sample_interval_ms=100
+ * trocksdb --benchmarks=put --max_background_compactions=16 --thread_tracking=true --thread_sample_interval_ms=100
+ *
+ * what the engine was doing at the worst ops, every thread keeps its 16 slowest ops above 10ms with
+ * the key, sizes, latency, stall condition, level0 files and immutable memtables right after them;
+ * slowest first at exit (ctrl-c) or from the admin port:
+ * trocksdb --benchmarks=put,get --slow_op_threshold_us=10000 --slow_ops_per_thread=16
+ * --slow_ops_file=trocksdb_slow_ops.json --admin_port=8081
+ * curl 'http://127.0.0.1:8081/slow_ops'
+ *
+ * no prometheus around, every metric is recorded each second to a compressed local file, exported to
+ * csv afterwards; steady series take a few bits a sample, 3000 series all changing every second about
+ * 9MB an hour, a killed run loses the last --tsdb_chunk_seconds:
+ * trocksdb --benchmarks=put --tsdb_file=trocksdb.tsdb --tsdb_interval_ms=1000
+ * trocksdb_dump --file=trocksdb.tsdb --match=engine_compaction_pending > pending.csv
  */
 
+static WriteMode ParseWriteMode(const std::string &write_mode) {
+    if (write_mode == "sequential") {
+        return SEQUENTIAL;
+    } else if (write_mode == "unique_random") {
+        return UNIQUE_RANDOM;
+    } else if (write_mode == "skewed") {
+        return SKEWED;
+    }
+    return RANDOM;
+}
+
+static bool ValidateWriteMode(const char *flagname, const std::string &value) {
+    if (value == "random" || value == "sequential" || value == "unique_random" || value == "skewed") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value
+              << ", use random/sequential/unique_random/skewed" << std::endl;
+    return false;
+}
+
+static const bool write_mode_validator_registered = RegisterFlagValidator(&FLAGS_write_mode, &ValidateWriteMode);
+
+static rocksdb::CompactionStyle ParseCompactionStyle(const std::string &compaction_style) {
+    if (compaction_style == "universal") {
+        return rocksdb::kCompactionStyleUniversal;
+    } else if (compaction_style == "fifo") {
+        return rocksdb::kCompactionStyleFIFO;
+    }
+    return rocksdb::kCompactionStyleLevel;
+}
+
+static bool ValidateCompactionStyle(const char *flagname, const std::string &value) {
+    if (value == "level" || value == "universal" || value == "fifo") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value << ", use level/universal/fifo" << std::endl;
+    return false;
+}
+
+static const bool compaction_style_validator_registered =
+        RegisterFlagValidator(&FLAGS_compaction_style, &ValidateCompactionStyle);
+
+static const struct {
+    const char *name;
+    rocksdb::CompressionType type;
+    const char *option;
+} compression_types[] = {
+        {"none",    rocksdb::kNoCompression,            "kNoCompression"},
+        {"snappy",  rocksdb::kSnappyCompression,        "kSnappyCompression"},
+        {"zlib",    rocksdb::kZlibCompression,          "kZlibCompression"},
+        {"lz4",     rocksdb::kLZ4Compression,           "kLZ4Compression"},
+        {"lz4hc",   rocksdb::kLZ4HCCompression,         "kLZ4HCCompression"},
+        {"zstd",    rocksdb::kZSTD,                     "kZSTD"},
+        {"disable", rocksdb::kDisableCompressionOption, "kDisableCompressionOption"},
+};
+
+static const char *CompressionOptionName(rocksdb::CompressionType type) {
+    for (auto &compression_type : compression_types) {
+        if (compression_type.type == type) {
+            return compression_type.option;
+        }
+    }
+    return "kNoCompression";
+}
+
+static bool ParseCompressionType(const std::string &name, rocksdb::CompressionType *type) {
+    for (auto &compression_type : compression_types) {
+        if (name == compression_type.name) {
+            *type = compression_type.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+// every level of num_levels, the last given type is repeated on the deeper levels
+static std::vector<rocksdb::CompressionType> ParseCompressionPerLevel(const std::string &value, int num_levels) {
+    std::vector<rocksdb::CompressionType> types;
+    std::istringstream in(value);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        rocksdb::CompressionType type = rocksdb::kNoCompression;
+        ParseCompressionType(name, &type);
+        types.push_back(type);
+    }
+    types.resize(num_levels, types.empty() ? rocksdb::kNoCompression : types.back());
+    return types;
+}
+
+static bool ValidateCompressionPerLevel(const char *flagname, const std::string &value) {
+    std::istringstream in(value);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        rocksdb::CompressionType type;
+        if (!ParseCompressionType(name, &type) || type == rocksdb::kDisableCompressionOption) {
+            std::cout << "Invalid value for --" << flagname << ": " << value
+                      << ", use none/snappy/zlib/lz4/lz4hc/zstd separated by comma" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static const bool compression_per_level_validator_registered =
+        RegisterFlagValidator(&FLAGS_compression_per_level, &ValidateCompressionPerLevel);
+
+static bool ValidateBottommostCompression(const char *flagname, const std::string &value) {
+    rocksdb::CompressionType type;
+    if (ParseCompressionType(value, &type)) {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value
+              << ", use disable/none/snappy/zlib/lz4/lz4hc/zstd" << std::endl;
+    return false;
+}
+
+static const bool bottommost_compression_validator_registered =
+        RegisterFlagValidator(&FLAGS_bottommost_compression, &ValidateBottommostCompression);
+
+static bool ValidateFilterPolicy(const char *flagname, const std::string &value) {
+    if (value == "none" || value == "bloom" || value == "ribbon" || value == "block") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value << ", use none/bloom/ribbon/block" << std::endl;
+    return false;
+}
+
+static const bool filter_policy_validator_registered =
+        RegisterFlagValidator(&FLAGS_filter_policy, &ValidateFilterPolicy);
+
+static const rocksdb::FilterPolicy *NewFilterPolicy() {
+    if (FLAGS_filter_policy == "bloom") {
+        return rocksdb::NewBloomFilterPolicy(FLAGS_bloom_bits_per_key, false);
+    } else if (FLAGS_filter_policy == "ribbon") {
+        return rocksdb::NewRibbonFilterPolicy(FLAGS_bloom_bits_per_key);
+    } else if (FLAGS_filter_policy == "block") {
+        return rocksdb::NewBloomFilterPolicy(FLAGS_bloom_bits_per_key, true);
+    }
+    return nullptr;
+}
+
+static bool ValidateIndexType(const char *flagname, const std::string &value) {
+    if (value == "binary" || value == "hash" || value == "two_level") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value << ", use binary/hash/two_level" << std::endl;
+    return false;
+}
+
+static const bool index_type_validator_registered = RegisterFlagValidator(&FLAGS_index_type, &ValidateIndexType);
+
+static rocksdb::BlockBasedTableOptions::IndexType ParseIndexType(const std::string &index_type) {
+    if (index_type == "hash") {
+        return rocksdb::BlockBasedTableOptions::kHashSearch;
+    } else if (index_type == "two_level") {
+        return rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    }
+    return rocksdb::BlockBasedTableOptions::kBinarySearch;
+}
+
+static bool ValidateTableFormat(const char *flagname, const std::string &value) {
+    if (value == "block_based" || value == "plain") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value << ", use block_based/plain" << std::endl;
+    return false;
+}
+
+static const bool table_format_validator_registered =
+        RegisterFlagValidator(&FLAGS_table_format, &ValidateTableFormat);
+
+// one bucket of the plain table hash index for every prefix, binary search of the keys without prefix
+static rocksdb::PlainTableOptions PlainTableOptions() {
+    rocksdb::PlainTableOptions plain_options;
+    plain_options.user_key_len = rocksdb::kPlainTableVariableLength;
+    plain_options.bloom_bits_per_key = FLAGS_filter_policy == "none" ? 0 : int(FLAGS_bloom_bits_per_key);
+    plain_options.hash_table_ratio = FLAGS_prefix_size > 0 ? 0.75 : 0;
+    return plain_options;
+}
+
+// the index and filter flags as block based table options, partitioned filters need the two level index
+static void SetIndexAndFilterOptions(rocksdb::BlockBasedTableOptions *table_options) {
+    table_options->index_type = ParseIndexType(FLAGS_index_type);
+    table_options->filter_policy.reset(NewFilterPolicy());
+    table_options->whole_key_filtering = FLAGS_whole_key_filtering;
+    table_options->partition_filters = FLAGS_partition_filters;
+    if (FLAGS_partition_filters) {
+        table_options->index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+    }
+}
+
+static bool ValidateEnv(const char *flagname, const std::string &value) {
+    if (value == "default" || value == "mem") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value << ", use default/mem" << std::endl;
+    return false;
+}
+
+static const bool env_validator_registered = RegisterFlagValidator(&FLAGS_env, &ValidateEnv);
+
+static bool ValidateCacheType(const char *flagname, const std::string &value) {
+    if (value == "lru" || value == "clock") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value << ", use lru/clock" << std::endl;
+    return false;
+}
+
+static const bool cache_type_validator_registered = RegisterFlagValidator(&FLAGS_cache_type, &ValidateCacheType);
+
+static bool ValidateIoLatencyDistribution(const char *flagname, const std::string &value) {
+    if (value == "fixed" || value == "uniform" || value == "exponential") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value
+              << ", use fixed/uniform/exponential" << std::endl;
+    return false;
+}
+
+static bool IsDefaultFlag(const char *name) {
+    return GetCommandLineFlagInfoOrDie(name).is_default;
+}
+
+// options flags given on the command line, as a rocksdb options string to override --config
+static std::string GivenFlagOptions() {
+    static const struct {
+        const char *flag;
+        const char *option;
+        int64_t unit;
+    } flag_options[] = {
+            {"wal_bytes_per_sync",                 "wal_bytes_per_sync",                      1024},
+            {"dynamic_level_bytes",                "level_compaction_dynamic_level_bytes",    0},
+            {"max_subcompactions",                 "max_subcompactions",                      0},
+            {"max_background_compactions",         "max_background_compactions",              0},
+            {"thread_tracking",                    "enable_thread_tracking",                  0},
+            {"write_buffer_size",                  "write_buffer_size",                       1024 * 1024},
+            {"max_bytes_for_level_base",           "max_bytes_for_level_base",                1024 * 1024},
+            {"level0_file_num_compaction_trigger", "level0_file_num_compaction_trigger",      0},
+            {"level0_slowdown_writes_trigger",     "level0_slowdown_writes_trigger",          0},
+            {"level0_stop_writes_trigger",         "level0_stop_writes_trigger",              0},
+            {"enable_blob_files",                  "enable_blob_files",                       0},
+            {"min_blob_size",                      "min_blob_size",                           0},
+            {"blob_file_size",                     "blob_file_size",                          1024 * 1024},
+            {"enable_blob_gc",                     "enable_blob_garbage_collection",          0},
+            {"blob_gc_age_cutoff",                 "blob_garbage_collection_age_cutoff",      0},
+            {"blob_gc_force_threshold",            "blob_garbage_collection_force_threshold", 0},
+            {"periodic_compaction_seconds",        "periodic_compaction_seconds",             0},
+            {"optimize_filters_for_hits",          "optimize_filters_for_hits",               0},
+            {"memtable_prefix_bloom_size_ratio",   "memtable_prefix_bloom_size_ratio",        0},
+    };
+    std::string opts;
+    for (auto &flag_option : flag_options) {
+        auto info = GetCommandLineFlagInfoOrDie(flag_option.flag);
+        if (info.is_default) {
+            continue;
+        }
+        auto value = info.current_value;
+        if (flag_option.unit) {
+            value = std::to_string(std::stoll(value) * flag_option.unit);
+        }
+        opts += std::string(flag_option.option) + "=" + value + ";";
+    }
+
+    // the compaction style and every sub-option given, also without the style itself
+    bool fifo = ParseCompactionStyle(FLAGS_compaction_style) == rocksdb::kCompactionStyleFIFO;
+    if (!IsDefaultFlag("compaction_style")) {
+        static const char *style_names[] = {"kCompactionStyleLevel", "kCompactionStyleUniversal",
+                                            "kCompactionStyleFIFO"};
+        opts += std::string("compaction_style=") + style_names[ParseCompactionStyle(FLAGS_compaction_style)] + ";";
+    }
+    std::string universal;
+    if (!IsDefaultFlag("universal_size_ratio")) {
+        universal += "size_ratio=" + std::to_string(FLAGS_universal_size_ratio) + ";";
+    }
+    if (!IsDefaultFlag("universal_min_merge_width")) {
+        universal += "min_merge_width=" + std::to_string(FLAGS_universal_min_merge_width) + ";";
+    }
+    if (!IsDefaultFlag("universal_max_size_amplification_percent")) {
+        universal += "max_size_amplification_percent="
+                      + std::to_string(FLAGS_universal_max_size_amplification_percent) + ";";
+    }
+    if (!universal.empty()) {
+        universal.pop_back();
+        opts += "compaction_options_universal={" + universal + "};";
+    }
+    std::string fifo_options;
+    if (!IsDefaultFlag("fifo_max_table_files_size_mb")) {
+        fifo_options += "max_table_files_size=" + std::to_string(uint64_t(FLAGS_fifo_max_table_files_size_mb) << 20)
+                        + ";";
+    }
+    if (!IsDefaultFlag("fifo_allow_compaction")) {
+        fifo_options += std::string("allow_compaction=") + (FLAGS_fifo_allow_compaction ? "true" : "false") + ";";
+    }
+    if (!fifo_options.empty()) {
+        fifo_options.pop_back();
+        opts += "compaction_options_fifo={" + fifo_options + "};";
+    }
+    if (!IsDefaultFlag("fifo_ttl_seconds") || (fifo && !IsDefaultFlag("compaction_style"))) {
+        opts += "ttl=" + std::to_string(FLAGS_fifo_ttl_seconds) + ";";
+    }
+
+    if (!IsDefaultFlag("compression_per_level")) {
+        std::string levels;
+        for (auto type : ParseCompressionPerLevel(FLAGS_compression_per_level, rocksdb::Options().num_levels)) {
+            levels += std::string(levels.empty() ? "" : ":") + CompressionOptionName(type);
+        }
+        opts += "compression_per_level=" + levels + ";";
+    }
+    if (!IsDefaultFlag("bottommost_compression")) {
+        rocksdb::CompressionType type = rocksdb::kDisableCompressionOption;
+        ParseCompressionType(FLAGS_bottommost_compression, &type);
+        opts += std::string("bottommost_compression=") + CompressionOptionName(type) + ";";
+    }
+    if (!IsDefaultFlag("compression_max_dict_bytes") || !IsDefaultFlag("compression_zstd_max_train_bytes")
+        || !IsDefaultFlag("compression_parallel_threads")) {
+        auto compression_opts = "{max_dict_bytes=" + std::to_string(FLAGS_compression_max_dict_bytes)
+                                + ";zstd_max_train_bytes=" + std::to_string(FLAGS_compression_zstd_max_train_bytes)
+                                + ";parallel_threads=" + std::to_string(FLAGS_compression_parallel_threads);
+        opts += "compression_opts=" + compression_opts + "};";
+        opts += "bottommost_compression_opts=" + compression_opts + ";enabled=true};";
+    }
+
+    if (!IsDefaultFlag("prefix_size")) {
+        opts += "prefix_extractor=" + (FLAGS_prefix_size > 0 ? "fixed:" + std::to_string(FLAGS_prefix_size)
+                                                             : std::string("nullptr")) + ";";
+    }
+    if (FLAGS_table_format == "plain") {
+        auto plain_options = PlainTableOptions();
+        std::ostringstream hash_table_ratio;
+        hash_table_ratio << plain_options.hash_table_ratio;
+        opts += "allow_mmap_reads=true;plain_table_factory={user_key_len=0;bloom_bits_per_key="
+                + std::to_string(plain_options.bloom_bits_per_key)
+                + ";hash_table_ratio=" + hash_table_ratio.str() + "};";
+    } else if (!IsDefaultFlag("filter_policy") || !IsDefaultFlag("bloom_bits_per_key") || !IsDefaultFlag("index_type")
+               || !IsDefaultFlag("partition_filters") || !IsDefaultFlag("whole_key_filtering")) {
+        std::ostringstream bits;
+        bits << FLAGS_bloom_bits_per_key;
+        std::string filter_policy = "nullptr";
+        if (FLAGS_filter_policy == "bloom") {
+            filter_policy = "bloomfilter:" + bits.str() + ":false";
+        } else if (FLAGS_filter_policy == "ribbon") {
+            filter_policy = "ribbonfilter:" + bits.str();
+        } else if (FLAGS_filter_policy == "block") {
+            filter_policy = "bloomfilter:" + bits.str() + ":true";
+        }
+        static const char *index_names[] = {"kBinarySearch", "kHashSearch", "kTwoLevelIndexSearch"};
+        auto index_type = FLAGS_partition_filters ? rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch
+                                                  : ParseIndexType(FLAGS_index_type);
+        opts += "block_based_table_factory={filter_policy=" + filter_policy
+                + ";whole_key_filtering=" + (FLAGS_whole_key_filtering ? "true" : "false")
+                + ";partition_filters=" + (FLAGS_partition_filters ? "true" : "false")
+                + ";index_type=" + index_names[index_type] + "};";
+    }
+    return opts;
+}
+
+static const bool io_latency_distribution_validator_registered =
+        RegisterFlagValidator(&FLAGS_io_latency_distribution, &ValidateIoLatencyDistribution);
+
+static IoShapingOptions ParseIoShapingOptions() {
+    IoShapingOptions options;
+    options.latency_distribution = FLAGS_io_latency_distribution;
+    options.read_latency_us = std::max<int64_t>(FLAGS_io_read_latency_us, 0);
+    options.write_latency_us = std::max<int64_t>(FLAGS_io_write_latency_us, 0);
+    options.sync_latency_us = std::max<int64_t>(FLAGS_io_sync_latency_us, 0);
+    options.bandwidth[IO_FILE_WAL] = uint64_t(std::max(FLAGS_io_wal_bandwidth_mb, 0)) << 20;
+    options.bandwidth[IO_FILE_SST] = uint64_t(std::max(FLAGS_io_sst_bandwidth_mb, 0)) << 20;
+    options.bandwidth[IO_FILE_MANIFEST] = uint64_t(std::max(FLAGS_io_manifest_bandwidth_mb, 0)) << 20;
+    options.spike_interval_ms = std::max<int64_t>(FLAGS_io_spike_interval_ms, 0);
+    options.spike_duration_ms = std::max<int64_t>(FLAGS_io_spike_duration_ms, 0);
+    options.spike_latency_us = std::max<int64_t>(FLAGS_io_spike_latency_us, 0);
+    return options;
+}
+
+// ttl of every column family, empty means not a ttl db
+static std::vector<int32_t> ParseTtls(const std::string &ttl_seconds, int column_family_num) {
+    std::vector<int32_t> ttls;
+    std::stringstream ss(ttl_seconds);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            ttls.push_back(std::stoi(item));
+        }
+    }
+    if (ttls.empty()) {
+        return ttls;
+    }
+    ttls.resize(column_family_num, ttls.back());
+    return ttls;
+}
+
+// comma separated seconds, e.g. 3600,600
+static bool ValidateTtls(const char *flagname, const std::string &value) {
+    if (value.empty()) {
+        return true;
+    }
+    std::stringstream ss(value);
+    std::string item;
+    int items = 0;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        if (item.size() > 9 || item.find_first_not_of("0123456789") != std::string::npos) {
+            items = 0;
+            break;
+        }
+        items++;
+    }
+    if (items > 0) {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value
+              << ", use comma separated seconds, e.g. 3600,600" << std::endl;
+    return false;
+}
+
+static const bool ttl_seconds_validator_registered = RegisterFlagValidator(&FLAGS_ttl_seconds, &ValidateTtls);
+
+static TxnMode ParseTxnMode(const std::string &txn) {
+    if (txn == "pessimistic") {
+        return TXN_PESSIMISTIC;
+    } else if (txn == "optimistic") {
+        return TXN_OPTIMISTIC;
+    }
+    return TXN_NONE;
+}
+
+static std::vector<std::string> ParseBenchmarks(const std::string &benchmarks) {
+    std::vector<std::string> names;
+    std::istringstream in(benchmarks);
+    std::string name;
+    while (std::getline(in, name, ',')) {
+        if (!name.empty()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+static bool ValidateBenchmarks(const char *flagname, const std::string &value) {
+    auto names = ParseBenchmarks(value);
+    for (auto &name : names) {
+        if (name != "put" && name != "batch" && name != "txn" && name != "get" && name != "get_miss"
+            && name != "seek") {
+            std::cout << "Invalid value for --" << flagname << ": " << value
+                      << ", use put/batch/txn/get/get_miss/seek separated by comma" << std::endl;
+            return false;
+        }
+    }
+    return !names.empty();
+}
+
+static const bool benchmarks_validator_registered = RegisterFlagValidator(&FLAGS_benchmarks, &ValidateBenchmarks);
+
+static bool ValidateTxn(const char *flagname, const std::string &value) {
+    if (value == "none" || value == "pessimistic" || value == "optimistic") {
+        return true;
+    }
+    std::cout << "Invalid value for --" << flagname << ": " << value
+              << ", use none/pessimistic/optimistic" << std::endl;
+    return false;
+}
+
+static const bool txn_validator_registered = RegisterFlagValidator(&FLAGS_txn, &ValidateTxn);
+
+
+// process wide resources shared by every rocksdb instance
+struct RocksdbResources {
+    rocksdb::Env *env = rocksdb::Env::Default();
+    std::shared_ptr<rocksdb::RateLimiter> rate_limiter;
+    // options of --config, nullptr uses the options flags
+    std::shared_ptr<OptionsConfig> config;
+    // with them every rocksdb and column family stays in one memory budget
+    std::shared_ptr<rocksdb::Cache> block_cache;
+    std::shared_ptr<rocksdb::WriteBufferManager> write_buffer_manager;
+};
 
 class RocksdbWarpper {
     static const size_t KB = 1024;
@@ -70,9 +795,14 @@ class RocksdbWarpper {
 public:
 
     RocksdbWarpper(int column_family_num, const std::string &dbpath,
-                   std::shared_ptr<StatisticsEventListener> listener)
+                   std::shared_ptr<StatisticsEventListener> listener,
+                   const RocksdbResources &resources,
+                   TxnMode txn_mode = TXN_NONE,
+                   const std::vector<int32_t> &ttls = std::vector<int32_t>())
             : column_family_num_(column_family_num),
-              dbpath_(dbpath), statistics_event_listener_(listener) {
+              dbpath_(dbpath), name_(dbpath.substr(dbpath.rfind('/') + 1)),
+              resources_(resources), txn_mode_(txn_mode), ttls_(ttls),
+              statistics_event_listener_(listener) {
         Open();
     }
 
@@ -87,6 +817,11 @@ public:
         return db_;
     }
 
+    // the db label of the metrics, the dir name of the rocksdb
+    const std::string &GetName() const {
+        return name_;
+    }
+
     std::vector<rocksdb::ColumnFamilyHandle *> GetColumnFamilyHandle() {
         return db_cfs_;
     }
@@ -95,12 +830,85 @@ private:
 
     void Open() {
         auto options = DefaultOptions();
+        auto column_families = DefaultColumnFamilies(column_family_num_);
+        if (resources_.config) {
+            ApplyConfig(*resources_.config, &options, &column_families);
+        }
+        if (resources_.block_cache) {
+            UseSharedCache(resources_.block_cache, &column_families);
+        }
+        options.write_buffer_manager = resources_.write_buffer_manager;
         options.listeners.push_back(statistics_event_listener_);
-        rocksdb::Status s = rocksdb::DB::Open(options, dbpath_, DefaultColumnFamilies(column_family_num_), &db_cfs_,
-                                              &db_);
+        options.env = resources_.env;
+        options.rate_limiter = resources_.rate_limiter;
+        rocksdb::Status s;
+        switch (txn_mode_) {
+            case TXN_PESSIMISTIC: {
+                rocksdb::TransactionDBOptions txn_db_options;
+                txn_db_options.transaction_lock_timeout = FLAGS_txn_lock_timeout;
+                rocksdb::TransactionDB *txn_db = nullptr;
+                s = rocksdb::TransactionDB::Open(options, txn_db_options, dbpath_,
+                                                 column_families, &db_cfs_, &txn_db);
+                db_ = txn_db;
+                break;
+            }
+            case TXN_OPTIMISTIC: {
+                rocksdb::OptimisticTransactionDB *txn_db = nullptr;
+                s = rocksdb::OptimisticTransactionDB::Open(options, dbpath_,
+                                                           column_families, &db_cfs_,
+                                                           &txn_db);
+                db_ = txn_db;
+                break;
+            }
+            default:
+                if (!ttls_.empty()) {
+                    // expired keys are dropped by the ttl compaction filter
+                    rocksdb::DBWithTTL *ttl_db = nullptr;
+                    s = rocksdb::DBWithTTL::Open(options, dbpath_, column_families,
+                                                 &db_cfs_, &ttl_db, ttls_);
+                    db_ = ttl_db;
+                } else {
+                    s = rocksdb::DB::Open(options, dbpath_, column_families, &db_cfs_,
+                                          &db_);
+                }
+                break;
+        }
         assert(s.ok());
     }
 
+    // the column families of the config replace the default ones in order, every db keeps its own statistics
+    static void ApplyConfig(const OptionsConfig &config, rocksdb::Options *options,
+                            std::vector<rocksdb::ColumnFamilyDescriptor> *column_families) {
+        auto statistics = options->statistics;
+        *static_cast<rocksdb::DBOptions *>(options) = config.db_options;
+        options->statistics = statistics;
+        options->create_if_missing = true;
+        options->create_missing_column_families = true;
+        for (size_t i = 0; i < column_families->size() && i < config.column_families.size(); i++) {
+            (*column_families)[i] = rocksdb::ColumnFamilyDescriptor(config.column_families[i].name,
+                                                                    config.column_families[i].options);
+        }
+        if (!config.column_families.empty()) {
+            *static_cast<rocksdb::ColumnFamilyOptions *>(options) = config.column_families.front().options;
+        }
+    }
+
+    static void UseSharedCache(const std::shared_ptr<rocksdb::Cache> &cache,
+                               std::vector<rocksdb::ColumnFamilyDescriptor> *column_families) {
+        for (auto &cf_desc : *column_families) {
+            auto &table_factory = cf_desc.options.table_factory;
+            auto table_options = table_factory ? table_factory->GetOptions<rocksdb::BlockBasedTableOptions>() : nullptr;
+            if (table_options == nullptr) {
+                continue;
+            }
+            auto shared_table_options = *table_options;
+            shared_table_options.block_cache = cache;
+            table_factory.reset(rocksdb::NewBlockBasedTableFactory(shared_table_options));
+        }
+    }
+
+public:
+
     static rocksdb::Options DefaultOptions() {
         //db options
         rocksdb::Options options;
@@ -122,15 +930,14 @@ private:
         options.level0_slowdown_writes_trigger = FLAGS_level0_slowdown_writes_trigger;
         options.level0_stop_writes_trigger = FLAGS_level0_stop_writes_trigger;
         options.max_write_buffer_number = 4;
-        options.compression_per_level = std::vector<rocksdb::CompressionType>{
-                rocksdb::CompressionType::kNoCompression,
-                rocksdb::CompressionType::kNoCompression,
-                rocksdb::CompressionType::kNoCompression,
-                rocksdb::CompressionType::kNoCompression,
-                rocksdb::CompressionType::kNoCompression,
-                rocksdb::CompressionType::kNoCompression,
-                rocksdb::CompressionType::kNoCompression
-        };
+        options.compression_per_level = ParseCompressionPerLevel(FLAGS_compression_per_level, options.num_levels);
+        ParseCompressionType(FLAGS_bottommost_compression, &options.bottommost_compression);
+        // a dictionary is sampled from the data of each sst (trained by zstd), helps the small blocks most
+        options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
+        options.compression_opts.zstd_max_train_bytes = FLAGS_compression_zstd_max_train_bytes;
+        options.compression_opts.parallel_threads = FLAGS_compression_parallel_threads;
+        options.bottommost_compression_opts = options.compression_opts;
+        options.bottommost_compression_opts.enabled = true;
 
         options.max_compaction_bytes = 2 * GB; //limit for this limited will to compact
         options.min_write_buffer_number_to_merge = 1; // immutable memtable should to merge before to level0
@@ -138,6 +945,7 @@ private:
         options.soft_pending_compaction_bytes_limit = 64 * GB; // slow write
         options.hard_pending_compaction_bytes_limit = 256 * GB; // stop write
         options.max_background_compactions = FLAGS_max_background_compactions;
+        options.enable_thread_tracking = FLAGS_thread_tracking;
         options.wal_bytes_per_sync = FLAGS_wal_bytes_per_sync * KB; //512 * KB;
         options.WAL_ttl_seconds = 0;
         options.WAL_size_limit_MB = 0;
@@ -146,7 +954,60 @@ private:
         options.allow_concurrent_memtable_write = true;
         options.enable_write_thread_adaptive_yield = true;
 
-        options.statistics = rocksdb::CreateDBStatistics();
+        /*
+         * blob files (key-value separation), values >= min_blob_size are written
+         * to blob files at flush, compaction only rewrites keys and blob indexes;
+         * gc relocates the valid blobs of the oldest age_cutoff fraction of files
+         */
+        options.enable_blob_files = FLAGS_enable_blob_files;
+        options.min_blob_size = FLAGS_min_blob_size;
+        options.blob_file_size = FLAGS_blob_file_size * MB;
+        options.enable_blob_garbage_collection = FLAGS_enable_blob_gc;
+        options.blob_garbage_collection_age_cutoff = FLAGS_blob_gc_age_cutoff;
+        options.blob_garbage_collection_force_threshold = FLAGS_blob_gc_force_threshold;
+
+        // files older than this are recompacted, so expired ttl data in cold levels is reclaimed
+        if (FLAGS_periodic_compaction_seconds >= 0) {
+            options.periodic_compaction_seconds = FLAGS_periodic_compaction_seconds;
+        }
+        // the last level holds most keys, skipping its filters saves most of the filter memory
+        options.optimize_filters_for_hits = FLAGS_optimize_filters_for_hits;
+        // keys of one tenant share the prefix: prefix bloom in ssts and memtables, hash index buckets
+        if (FLAGS_prefix_size > 0) {
+            options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(FLAGS_prefix_size));
+        }
+        options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_prefix_bloom_size_ratio;
+        // plain table reads the ssts by mmap only
+        options.allow_mmap_reads = FLAGS_table_format == "plain";
+
+        /*
+         * universal: sorted runs (level0 files + non-empty levels) are merged when they have
+         *            similar sizes or the size amplification is too high, less write-amp
+         * fifo:      every file stays in level0, the oldest is dropped above the size or ttl,
+         *            for time series data that is only appended and expired
+         */
+        options.compaction_style = ParseCompactionStyle(FLAGS_compaction_style);
+        options.compaction_options_universal.size_ratio = FLAGS_universal_size_ratio;
+        options.compaction_options_universal.min_merge_width = FLAGS_universal_min_merge_width;
+        options.compaction_options_universal.max_size_amplification_percent =
+                FLAGS_universal_max_size_amplification_percent;
+        options.compaction_options_fifo.max_table_files_size = uint64_t(FLAGS_fifo_max_table_files_size_mb) * MB;
+        options.compaction_options_fifo.allow_compaction = FLAGS_fifo_allow_compaction;
+        if (options.compaction_style == rocksdb::kCompactionStyleFIFO) {
+            options.ttl = FLAGS_fifo_ttl_seconds;
+        }
+
+        // histograms also counted into cumulative buckets, the statistics are never reset
+        options.statistics = std::make_shared<CumulativeStatistics>();
+        // COMPRESSION_TIMES_NANOS/DECOMPRESSION_TIMES_NANOS are only timed above the default level
+        bool compressed = options.bottommost_compression != rocksdb::kDisableCompressionOption
+                          && options.bottommost_compression != rocksdb::kNoCompression;
+        for (auto type : options.compression_per_level) {
+            compressed = compressed || type != rocksdb::kNoCompression;
+        }
+        if (compressed) {
+            options.statistics->set_stats_level(rocksdb::kExceptTimeForMutex);
+        }
 //        options.listeners.push_back(statistics_event_listener_);
         return options;
     }
@@ -169,10 +1030,14 @@ private:
             table_options.block_cache = cache;
             table_options.block_size = 16 * KB;
             table_options.cache_index_and_filter_blocks = true; // cache bloom in block cache
-            table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(2, false));
+            SetIndexAndFilterOptions(&table_options);
 
             auto options = DefaultOptions();
-            options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+            if (FLAGS_table_format == "plain") {
+                options.table_factory.reset(rocksdb::NewPlainTableFactory(PlainTableOptions()));
+            } else {
+                options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+            }
             auto column_options = rocksdb::ColumnFamilyOptions(options);
 
             //column options
@@ -181,7 +1046,7 @@ private:
             column_options.max_compaction_bytes = 2 * GB; //limit for this limited will to compact
             column_options.min_write_buffer_number_to_merge = 1; // immutable memtable should to merge before to level0
             column_options.max_bytes_for_level_multiplier = 10;
-            column_options.level_compaction_dynamic_level_bytes = false;
+            column_options.level_compaction_dynamic_level_bytes = FLAGS_dynamic_level_bytes;
             column_options.target_file_size_base =
                     64 * MB; // level1 sst size; suggest is: max_bytes_for_level_base / 10
             column_options.target_file_size_multiplier = 1; // leveln sst size = level1_sst.size * n
@@ -196,124 +1061,599 @@ private:
 private:
     int column_family_num_;
     std::string dbpath_;
+    std::string name_;
+    RocksdbResources resources_;
+    TxnMode txn_mode_;
+    std::vector<int32_t> ttls_;
     rocksdb::DB *db_;
     std::vector<rocksdb::ColumnFamilyHandle *> db_cfs_;
     std::shared_ptr<StatisticsEventListener> statistics_event_listener_;
 };
 
 class TestRocksDB {
-    static const int DEFAULT_FLUSHER_RESET_INTERVAL = 60000;
-
 public:
     TestRocksDB(const std::string &dbpath, const std::string &host)
             : metrics_service_(host), sys_statistics_(), rocksdb_statistics_(),
-              statistics_stop_(false),
-              statistics_event_listener_(new StatisticsEventListener("test", rocksdb_statistics_)),
-              benchmark_(FLAGS_nums, FLAGS_value_size, FLAGS_sync, FLAGS_disable_wal) {
-        metrics_service_.RegisterCollectableV2(sys_statistics_.GetRegistry(),
-                                               rocksdb_statistics_.GetRegistry(),
-                                               benchmark_.GetRegistry());
+              histogram_collector_(new CumulativeHistogramCollector()),
+              trace_recorder_(FLAGS_trace_events > 0 ? new TraceRecorder(size_t(FLAGS_trace_events)) : nullptr),
+              slow_op_recorder_(FLAGS_slow_ops_per_thread > 0
+                                ? new SlowOpRecorder(size_t(FLAGS_slow_ops_per_thread),
+                                                     uint64_t(FLAGS_slow_op_threshold_us))
+                                : nullptr),
+              benchmark_(FLAGS_nums, FLAGS_value_size, FLAGS_sync, FLAGS_disable_wal,
+                         KeyFormat(FLAGS_key_prefix_num, FLAGS_prefix_size), FLAGS_perf_sample_every,
+                         slow_op_recorder_.get()) {
+        rocksdb_statistics_.SetFullFilter(FLAGS_filter_policy != "block");
+        if (FLAGS_collect_on_scrape) {
+            // the rocksdb and system registries are collected by the scrape collector after flushing
+            scrape_collector_.reset(new ScrapeCollector(std::chrono::milliseconds(FLAGS_scrape_min_interval_ms)));
+            scrape_collector_->Add(sys_statistics_.GetRegistry());
+            scrape_collector_->Add(rocksdb_statistics_.GetRegistry());
+            metrics_service_.RegisterCollectableV2(std::weak_ptr<prometheus::Collectable>(scrape_collector_),
+                                                   benchmark_.GetRegistry(),
+                                                   thread_status_statistics_.GetRegistry(),
+                                                   io_statistics_.GetRegistry(),
+                                                   rate_limiter_statistics_.GetRegistry(),
+                                                   std::weak_ptr<prometheus::Collectable>(histogram_collector_));
+        } else {
+            metrics_service_.RegisterCollectableV2(sys_statistics_.GetRegistry(),
+                                                   rocksdb_statistics_.GetRegistry(),
+                                                   benchmark_.GetRegistry(),
+                                                   thread_status_statistics_.GetRegistry(),
+                                                   io_statistics_.GetRegistry(),
+                                                   rate_limiter_statistics_.GetRegistry(),
+                                                   std::weak_ptr<prometheus::Collectable>(histogram_collector_));
+        }
+        BuildResources();
     }
 
     ~TestRocksDB() {
+        if (scrape_collector_) {
+            scrape_collector_->SetCollect(nullptr);
+        }
+        if (metrics_scheduler_) {
+            metrics_scheduler_->Stop();
+        }
+        thread_status_statistics_.Stop();
+    }
+
+    void BuildResources() {
+        if (!FLAGS_config.empty()) {
+            auto config = std::make_shared<OptionsConfig>();
+            auto s = LoadOptionsConfig(FLAGS_config, FLAGS_config_section,
+                                       RocksdbWarpper::DefaultOptions(),
+                                       RocksdbWarpper::DefaultColumnFamilies(1).front().options,
+                                       config.get());
+            if (s.ok()) {
+                s = OverrideOptionsConfig(GivenFlagOptions(), config.get());
+            }
+            if (!s.ok()) {
+                std::cout << "Error of --config " << FLAGS_config << ": " << s.ToString() << std::endl;
+                exit(-1);
+            }
+            resources_.config = config;
+        }
+
+        if (FLAGS_env == "mem") {
+            // files live in memory and fsync is a no-op, results show the cpu cost only
+            mem_env_.reset(rocksdb::NewMemEnv(rocksdb::Env::Default()));
+            resources_.env = mem_env_.get();
+            sys_statistics_.SetRunInfo("mem", "cpu");
+        } else {
+            sys_statistics_.SetRunInfo("default", "disk");
+        }
+
+        auto shaping_options = ParseIoShapingOptions();
+        if (shaping_options.Enabled()) {
+            // delays are injected above whatever file system the env has, mem env included
+            auto fs = std::make_shared<ShapingFileSystem>(resources_.env->GetFileSystem(),
+                                                          shaping_options, io_statistics_);
+            shaping_env_ = rocksdb::NewCompositeEnv(fs);
+            resources_.env = shaping_env_.get();
+        }
+
+        if (FLAGS_io_accounting) {
+            auto fs = std::make_shared<AccountingFileSystem>(resources_.env->GetFileSystem(), io_statistics_);
+            accounting_env_ = rocksdb::NewCompositeEnv(fs);
+            resources_.env = accounting_env_.get();
+        }
+
+        if (FLAGS_shared_cache_mb > 0) {
+            auto capacity = size_t(FLAGS_shared_cache_mb) << 20;
+            if (FLAGS_cache_type == "clock") {
+                resources_.block_cache = rocksdb::NewClockCache(capacity, FLAGS_cache_shard_bits);
+                if (!resources_.block_cache) {
+                    std::cout << "clock cache is not supported by this rocksdb build, use lru cache" << std::endl;
+                }
+            }
+            if (!resources_.block_cache) {
+                resources_.block_cache = rocksdb::NewLRUCache(capacity, FLAGS_cache_shard_bits);
+            }
+        }
+        if (FLAGS_write_buffer_manager_mb > 0) {
+            // memtables reserve dummy entries in the cache, so they evict blocks instead of adding to them
+            resources_.write_buffer_manager = std::make_shared<rocksdb::WriteBufferManager>(
+                    size_t(FLAGS_write_buffer_manager_mb) << 20, resources_.block_cache);
+        }
+
+        int64_t rate_bytes_per_sec = int64_t(FLAGS_rate_limit_mb) << 20;
+        if (resources_.config && IsDefaultFlag("rate_limit_mb")) {
+            rate_bytes_per_sec = resources_.config->rate_bytes_per_sec;
+        }
+        if (rate_bytes_per_sec > 0) {
+            // one limiter for every rocksdb, they share the same disk
+            std::shared_ptr<rocksdb::RateLimiter> rate_limiter(rocksdb::NewGenericRateLimiter(
+                    rate_bytes_per_sec, 100 * 1000, 10,
+                    rocksdb::RateLimiter::Mode::kWritesOnly, FLAGS_rate_limit_auto_tune));
+            resources_.rate_limiter = std::make_shared<InstrumentedRateLimiter>(
+                    rate_limiter, rocksdb::RateLimiter::Mode::kWritesOnly,
+                    FLAGS_rate_limit_auto_tune, rate_limiter_statistics_);
+        }
     }
 
     void RunTest(int rocksdb_num = 1, int column_family_nums = 1) {
-        mkdir("rocksdb_data", 0755);
+        if (FLAGS_env != "mem") {
+            mkdir("rocksdb_data", 0755);
+        }
+        if (resources_.config && !resources_.config->column_families.empty() && IsDefaultFlag("rocksdb_columns")) {
+            column_family_nums = int(resources_.config->column_families.size());
+        }
         for (int i = 0; i < rocksdb_num; i++) {
+            auto name = std::string("rocks") + std::to_string(i);
             auto db_ptr = std::shared_ptr<RocksdbWarpper>(new RocksdbWarpper(
                     column_family_nums,
-                    std::string("rocksdb_data/rocks") + std::to_string(i),
-                    statistics_event_listener_));
+                    "rocksdb_data/" + name,
+                    std::make_shared<StatisticsEventListener>(name, rocksdb_statistics_, trace_recorder_.get()),
+                    resources_,
+                    ParseTxnMode(FLAGS_txn),
+                    ParseTtls(FLAGS_ttl_seconds, column_family_nums)));
             rocksdbs_.push_back(db_ptr);
+            auto statistics = std::dynamic_pointer_cast<CumulativeStatistics>(
+                    db_ptr->GetDB()->GetDBOptions().statistics);
+            if (statistics) {
+                histogram_collector_->Add(db_ptr->GetName(), statistics);
+            }
             for (int j = 0; j < column_family_nums; j++) {
-                if (FLAGS_benchmarks == "put") {
-                    benchmark_.Put(FLAGS_threads, db_ptr->GetDB(),
-                                   db_ptr->GetColumnFamilyHandle()[j]);
-                } else if (FLAGS_benchmarks == "batch") {
-                    benchmark_.BenchPut(FLAGS_threads, FLAGS_batch_num,
-                                        db_ptr->GetDB(), db_ptr->GetColumnFamilyHandle()[j]);
-                } else {
-                    std::cout << "Error of benchmarks params, use --benchmarks=put/batch" << std::endl;
-                    exit(-1);
+                for (auto &name : ParseBenchmarks(FLAGS_benchmarks)) {
+                    if (name == "put") {
+                        benchmark_.Put(FLAGS_threads, db_ptr->GetDB(),
+                                       db_ptr->GetColumnFamilyHandle()[j],
+                                       ParseWriteMode(FLAGS_write_mode));
+                    } else if (name == "batch") {
+                        benchmark_.BenchPut(FLAGS_threads, FLAGS_batch_num,
+                                            db_ptr->GetDB(), db_ptr->GetColumnFamilyHandle()[j],
+                                            ParseWriteMode(FLAGS_write_mode));
+                    } else if (name == "get" || name == "get_miss") {
+                        benchmark_.Get(FLAGS_threads, name == "get_miss",
+                                       db_ptr->GetDB(), db_ptr->GetColumnFamilyHandle()[j],
+                                       ParseWriteMode(FLAGS_write_mode));
+                    } else if (name == "seek") {
+                        benchmark_.Seek(FLAGS_threads, FLAGS_seek_nexts,
+                                        db_ptr->GetDB(), db_ptr->GetColumnFamilyHandle()[j],
+                                        ParseWriteMode(FLAGS_write_mode));
+                    } else if (name == "txn" && ParseTxnMode(FLAGS_txn) != TXN_NONE) {
+                        benchmark_.Txn(FLAGS_threads, ParseTxnMode(FLAGS_txn), FLAGS_txn_keys,
+                                       FLAGS_txn_deadlock_detect,
+                                       db_ptr->GetDB(), db_ptr->GetColumnFamilyHandle()[j]);
+                    } else {
+                        std::cout << "Error of benchmarks params, use --benchmarks=put/batch/txn/get/get_miss/seek"
+                                     " (txn needs --txn=pessimistic/optimistic)" << std::endl;
+                        exit(-1);
+                    }
                 }
             }
         }
 
+        StartAdminService();
         RunStatistics();
+        RunThreadStatus();
+        RunTsdbRecorder();
         benchmark_.Join();
     }
 
-    void RunStatistics() {
-        statistics_thread_ = std::move(std::thread(std::bind(&TestRocksDB::FlushMetrics, this)));
+    void StartAdminService() {
+        if (FLAGS_admin_port <= 0) {
+            return;
+        }
+        admin_service_.reset(new HttpService(FLAGS_admin_bind + ":" + std::to_string(FLAGS_admin_port)));
+        admin_service_->RegisterHandler("/set_options", std::bind(&TestRocksDB::HandleSetOptions, this,
+                                                                  std::placeholders::_1, false));
+        admin_service_->RegisterHandler("/set_db_options", std::bind(&TestRocksDB::HandleSetOptions, this,
+                                                                     std::placeholders::_1, true));
+        if (trace_recorder_) {
+            admin_service_->RegisterHandler("/trace", [this](const HttpRequest &) {
+                HttpResponse response;
+                response.content_type = "application/json";
+                response.body = trace_recorder_->Dump();
+                return response;
+            });
+        }
+        if (slow_op_recorder_) {
+            admin_service_->RegisterHandler("/slow_ops", [this](const HttpRequest &) {
+                HttpResponse response;
+                response.content_type = "application/json";
+                response.body = slow_op_recorder_->Dump();
+                return response;
+            });
+        }
+        admin_service_->Start();
     }
 
-    void FlushMetrics() {
-        auto reset_time = std::chrono::system_clock::now()
-                          + std::chrono::milliseconds(1 * DEFAULT_FLUSHER_RESET_INTERVAL);
-
-        while (!statistics_stop_) {
-            for (auto &db : rocksdbs_) {
-                rocksdb_statistics_.FlushMetrics(*db->GetDB(), "test", db->GetColumnFamilyHandle());
-                std::this_thread::sleep_for(std::chrono::seconds(2));
-                sys_statistics_.FlushMetrics(".");
+    // SetOptions/SetDBOptions on the dbs and column families matched by db= and cf=
+    HttpResponse HandleSetOptions(const HttpRequest &request, bool db_options) {
+        HttpResponse response;
+        std::unordered_map<std::string, std::string> options;
+        for (auto &pair : request.params) {
+            if (pair.first != "db" && pair.first != "cf") {
+                options.insert(pair);
+            }
+        }
+        auto db_param = request.Param("db");
+        auto cf_param = request.Param("cf");
+        if (options.empty() || (db_options && cf_param)) {
+            response.status = 400;
+            response.body = db_options ? "use /set_db_options?[db=rocks0&]option=value\n"
+                                       : "use /set_options?[db=rocks0&][cf=default&]option=value\n";
+            return response;
+        }
 
-                auto now_time = std::chrono::system_clock::now();
-                if (now_time > reset_time) {
-                    db->GetDB()->GetDBOptions().statistics->Reset();
-                    reset_time = now_time + std::chrono::milliseconds(1 * DEFAULT_FLUSHER_RESET_INTERVAL);
+        for (size_t i = 0; i < rocksdbs_.size(); i++) {
+            // the db label of the metrics (the dir name), or the index of --rocksdb_num
+            if (db_param && *db_param != rocksdbs_[i]->GetName() && *db_param != std::to_string(i)) {
+                continue;
+            }
+            auto db = rocksdbs_[i]->GetDB();
+            if (db_options) {
+                auto s = db->SetDBOptions(options);
+                response.body += "db " + rocksdbs_[i]->GetName() + ": " + s.ToString() + "\n";
+                if (!s.ok()) {
+                    response.status = 400;
+                    continue;
+                }
+                for (auto &pair : options) {
+                    rocksdb_statistics_.RecordOptionChanged(rocksdbs_[i]->GetName(), "", pair.first, pair.second);
+                }
+                continue;
+            }
+            for (auto cf : rocksdbs_[i]->GetColumnFamilyHandle()) {
+                if (cf_param && *cf_param != cf->GetName()) {
+                    continue;
+                }
+                auto s = db->SetOptions(cf, options);
+                response.body += "db " + rocksdbs_[i]->GetName() + " cf " + cf->GetName() + ": " + s.ToString() + "\n";
+                if (!s.ok()) {
+                    response.status = 400;
+                    continue;
+                }
+                for (auto &pair : options) {
+                    rocksdb_statistics_.RecordOptionChanged(rocksdbs_[i]->GetName(), cf->GetName(), pair.first, pair.second);
                 }
-
             }
         }
+        if (response.body.empty()) {
+            response.status = 404;
+            response.body = "no db or column family matched\n";
+        }
+        return response;
+    }
+
+    // the benchmark threads return, RunTest returns once they did
+    void Stop() {
+        benchmark_.Stop();
+    }
+
+    void DumpTrace() {
+        if (!trace_recorder_ || FLAGS_trace_file.empty()) {
+            return;
+        }
+        std::ofstream out(FLAGS_trace_file);
+        out << trace_recorder_->Dump();
+        std::cout << "trace of flushes, compactions and stalls: " << FLAGS_trace_file << std::endl;
+    }
+
+    void DumpSlowOps() {
+        if (!slow_op_recorder_ || FLAGS_slow_ops_file.empty()) {
+            return;
+        }
+        std::ofstream out(FLAGS_slow_ops_file);
+        out << slow_op_recorder_->Dump();
+        std::cout << "slowest benchmark ops: " << FLAGS_slow_ops_file << std::endl;
+    }
+
+    // a task of every rocksdb under its own name, and one of the shared memory budget and the system
+    void RunStatistics() {
+        metrics_scheduler_.reset(new MetricsScheduler(FLAGS_metrics_threads));
+        for (auto &db : rocksdbs_) {
+            metrics_scheduler_->Add(std::bind(&TestRocksDB::FlushMetrics, this, db));
+        }
+        metrics_scheduler_->Add([this] {
+            rocksdb_statistics_.FlushMemoryBudget(resources_.block_cache.get(),
+                                                  resources_.write_buffer_manager.get());
+            sys_statistics_.FlushMetrics(".");
+        });
+        if (scrape_collector_) {
+            // every rocksdb is opened, the scrapes may walk them from now on
+            scrape_collector_->SetCollect(std::bind(&MetricsScheduler::RunOnce, metrics_scheduler_.get()));
+            return;
+        }
+        metrics_scheduler_->Start(std::chrono::milliseconds(FLAGS_metrics_interval_ms));
+    }
+
+    // sampled far more often than the other metrics, a compaction may run only a few seconds
+    void RunThreadStatus() {
+        if (!FLAGS_thread_tracking) {
+            return;
+        }
+        auto env = resources_.env ? resources_.env : rocksdb::Env::Default();
+        thread_status_statistics_.Start(env, std::chrono::milliseconds(FLAGS_thread_sample_interval_ms));
+    }
+
+    // the same registries as the prometheus exposer
+    void RunTsdbRecorder() {
+        if (FLAGS_tsdb_file.empty()) {
+            return;
+        }
+        tsdb_recorder_.reset(new TsdbRecorder(FLAGS_tsdb_file, std::chrono::milliseconds(FLAGS_tsdb_interval_ms),
+                                            std::chrono::seconds(FLAGS_tsdb_chunk_seconds)));
+        if (scrape_collector_) {
+            tsdb_recorder_->Add(std::weak_ptr<prometheus::Collectable>(scrape_collector_));
+        } else {
+            tsdb_recorder_->Add(sys_statistics_.GetRegistry());
+            tsdb_recorder_->Add(rocksdb_statistics_.GetRegistry());
+        }
+        tsdb_recorder_->Add(benchmark_.GetRegistry());
+        tsdb_recorder_->Add(thread_status_statistics_.GetRegistry());
+        tsdb_recorder_->Add(io_statistics_.GetRegistry());
+        tsdb_recorder_->Add(rate_limiter_statistics_.GetRegistry());
+        tsdb_recorder_->Add(std::weak_ptr<prometheus::Collectable>(histogram_collector_));
+        if (!tsdb_recorder_->Start()) {
+            std::cout << "Error of create the tsdb file " << FLAGS_tsdb_file << std::endl;
+            tsdb_recorder_.reset();
+        }
+    }
+
+    // the samples not written yet are written
+    void StopTsdbRecorder() {
+        if (!tsdb_recorder_) {
+            return;
+        }
+        tsdb_recorder_->Stop();
+        std::cout << "metrics time series: " << FLAGS_tsdb_file << std::endl;
+    }
+
+    void FlushMetrics(const std::shared_ptr<RocksdbWarpper> &db) {
+        rocksdb_statistics_.FlushMetrics(*db->GetDB(), db->GetName(), db->GetColumnFamilyHandle());
     }
 
 private:
     PrometheusService metrics_service_;
     SystemStatistics sys_statistics_;
     RocksdbStatistics rocksdb_statistics_;
-    std::thread statistics_thread_;
-    bool statistics_stop_;
-    std::shared_ptr<StatisticsEventListener> statistics_event_listener_;
+    ThreadStatusStatistics thread_status_statistics_;
+    std::unique_ptr<MetricsScheduler> metrics_scheduler_;
+    std::shared_ptr<CumulativeHistogramCollector> histogram_collector_;
+    std::shared_ptr<ScrapeCollector> scrape_collector_;
+    std::unique_ptr<TraceRecorder> trace_recorder_;
+    std::unique_ptr<SlowOpRecorder> slow_op_recorder_;
+    std::unique_ptr<TsdbRecorder> tsdb_recorder_;
+    IoStatistics io_statistics_;
+    RateLimiterStatistics rate_limiter_statistics_;
+    std::unique_ptr<rocksdb::Env> mem_env_;
+    std::unique_ptr<rocksdb::Env> shaping_env_;
+    std::unique_ptr<rocksdb::Env> accounting_env_;
+    RocksdbResources resources_;
     Benchmark benchmark_;
     std::vector<std::shared_ptr<RocksdbWarpper>> rocksdbs_;
+    std::unique_ptr<HttpService> admin_service_;
 };
 
 
 void PrintCommandLine() {
+    if (FLAGS_env == "mem") {
+        std::cout << "********************************************************************" << std::endl;
+        std::cout << "* env=mem: CPU-BOUND run, all files in memory, no disk io/fsync.   *" << std::endl;
+        std::cout << "* Do not compare these results with disk-bound (env=default) runs. *" << std::endl;
+        std::cout << "********************************************************************" << std::endl;
+    }
     std::cout << "prometheus port      : " << FLAGS_prometheus_port << std::endl;
+    if (FLAGS_admin_port > 0) {
+        std::cout << "admin port           : " << FLAGS_admin_bind << ":" << FLAGS_admin_port
+                  << " (/set_options, /set_db_options)" << std::endl;
+    }
+    if (FLAGS_collect_on_scrape) {
+        std::cout << "metrics collect      : on scrape, cached " << FLAGS_scrape_min_interval_ms << "ms" << std::endl;
+    } else {
+        std::cout << "metrics collect      : every " << FLAGS_metrics_interval_ms << "ms, "
+                  << FLAGS_metrics_threads << " threads" << std::endl;
+    }
+    std::cout << "rocksdb env          : " << FLAGS_env << (FLAGS_env == "mem" ? " (cpu-bound)" : " (disk-bound)")
+              << std::endl;
     std::cout << "benchmarks type      : " << FLAGS_benchmarks << std::endl;
+    if (FLAGS_trace_events > 0) {
+        std::cout << "trace events         : " << FLAGS_trace_events << " -> "
+                  << (FLAGS_trace_file.empty() ? "(admin port /trace only)" : FLAGS_trace_file) << std::endl;
+    }
+    if (FLAGS_slow_ops_per_thread > 0) {
+        std::cout << "slow ops             : " << FLAGS_slow_ops_per_thread << " a thread above "
+                  << FLAGS_slow_op_threshold_us << "us -> "
+                  << (FLAGS_slow_ops_file.empty() ? "(admin port /slow_ops only)" : FLAGS_slow_ops_file) << std::endl;
+    }
+    if (!FLAGS_tsdb_file.empty()) {
+        std::cout << "tsdb file            : " << FLAGS_tsdb_file << ", every " << FLAGS_tsdb_interval_ms << "ms, "
+                  << FLAGS_tsdb_chunk_seconds << "s chunks" << std::endl;
+    }
+    std::cout << "perf sample every    : " << FLAGS_perf_sample_every << (FLAGS_perf_sample_every > 0 ? " ops" : " (disable)")
+              << std::endl;
     std::cout << "every columns threads: " << FLAGS_threads << std::endl;
     std::cout << "value size           : " << FLAGS_value_size << std::endl;
     std::cout << "write key nums       : " << FLAGS_nums << std::endl;
     std::cout << "how many rocksdb use : " << FLAGS_rocksdb_num << std::endl;
     std::cout << "every rocksdb use columns: " << FLAGS_rocksdb_columns << std::endl;
     std::cout << "if use batch, batch num  : " << FLAGS_batch_num << std::endl;
+    std::cout << "put/batch key write mode : " << FLAGS_write_mode << std::endl;
+    std::cout << "transaction db type      : " << FLAGS_txn << std::endl;
+    if (ParseTxnMode(FLAGS_txn) != TXN_NONE) {
+        std::cout << "if use txn, keys per txn : " << FLAGS_txn_keys << std::endl;
+        std::cout << "if use txn, lock timeout : " << FLAGS_txn_lock_timeout << "ms" << std::endl;
+        std::cout << "if use txn, deadlock detect: " << (FLAGS_txn_deadlock_detect ? "true" : "false") << std::endl;
+    }
 
     std::cout<<std::endl;
 
+    if (!FLAGS_config.empty()) {
+        std::cout << "options --> config            : " << FLAGS_config << " [" << FLAGS_config_section << "]"
+                  << ", the options below are overridden only when given" << std::endl;
+    }
     std::cout << "options --> write_sync        : " << (FLAGS_sync ? "true" : "false") << std::endl;
     std::cout << "options --> wal_bytes_per_sync: " << FLAGS_wal_bytes_per_sync << "KB" << std::endl;
     std::cout << "options --> disable_wal       : " << (FLAGS_disable_wal ? "true" : "false") << std::endl;
     std::cout << "options --> level_compaction_dynamic_level_bytes: "<< (FLAGS_dynamic_level_bytes ? "true" : "false") << std::endl;
     std::cout << "options --> max_subcompactions  : " << FLAGS_max_subcompactions << std::endl;
     std::cout << "options --> max_background_compactions : " << FLAGS_max_background_compactions << std::endl;
+    std::cout << "options --> enable_thread_tracking     : " << (FLAGS_thread_tracking ? "true" : "false");
+    if (FLAGS_thread_tracking) {
+        std::cout << " (sampled every " << FLAGS_thread_sample_interval_ms << "ms)";
+    }
+    std::cout << std::endl;
     std::cout << "options --> write_buffer_size          : " << FLAGS_write_buffer_size << "MB" << std::endl;
     std::cout << "options --> max_bytes_for_level_base   : " << FLAGS_max_bytes_for_level_base << "MB" << std::endl;
     std::cout << "options --> level0_file_num_compaction_trigger : " << FLAGS_level0_file_num_compaction_trigger << std::endl;
     std::cout << "options --> level0_slowdown_writes_trigger : " << FLAGS_level0_slowdown_writes_trigger << std::endl;
     std::cout << "options --> level0_stop_writes_trigger     : " << FLAGS_level0_stop_writes_trigger << std::endl;
+    std::cout << "options --> compaction_style  : " << FLAGS_compaction_style << std::endl;
+    if (FLAGS_compaction_style == "universal") {
+        std::cout << "options --> universal size_ratio/min_merge_width/max_size_amplification : "
+                  << FLAGS_universal_size_ratio << "%/" << FLAGS_universal_min_merge_width << "/"
+                  << FLAGS_universal_max_size_amplification_percent << "%" << std::endl;
+    } else if (FLAGS_compaction_style == "fifo") {
+        std::cout << "options --> fifo max_table_files_size/ttl/allow_compaction : "
+                  << FLAGS_fifo_max_table_files_size_mb << "MB/" << FLAGS_fifo_ttl_seconds << "s/"
+                  << (FLAGS_fifo_allow_compaction ? "true" : "false") << std::endl;
+    }
+    std::cout << "options --> compression_per_level  : " << FLAGS_compression_per_level << std::endl;
+    std::cout << "options --> bottommost_compression : " << FLAGS_bottommost_compression << std::endl;
+    std::cout << "options --> compression max_dict_bytes/zstd_max_train_bytes/parallel_threads : "
+              << FLAGS_compression_max_dict_bytes << "B/" << FLAGS_compression_zstd_max_train_bytes << "B/"
+              << FLAGS_compression_parallel_threads << std::endl;
+    std::cout << "options --> filter_policy     : " << FLAGS_filter_policy << ", "
+              << FLAGS_bloom_bits_per_key << " bits per key" << (FLAGS_partition_filters ? ", partitioned" : "")
+              << (FLAGS_whole_key_filtering ? "" : ", no whole key") << std::endl;
+    std::cout << "options --> optimize_filters_for_hits : " << (FLAGS_optimize_filters_for_hits ? "true" : "false")
+              << std::endl;
+    std::cout << "options --> table_format      : " << FLAGS_table_format
+              << (FLAGS_table_format == "plain" ? "" : ", " + FLAGS_index_type + " index") << std::endl;
+    std::cout << "options --> prefix_size       : " << FLAGS_prefix_size << ", memtable prefix bloom ratio "
+              << FLAGS_memtable_prefix_bloom_size_ratio << std::endl;
+    if (FLAGS_key_prefix_num > 0) {
+        std::cout << "key tenant prefixes      : " << FLAGS_key_prefix_num << std::endl;
+    }
+    std::cout << "options --> ttl_seconds       : " << (FLAGS_ttl_seconds.empty() ? "none" : FLAGS_ttl_seconds) << std::endl;
+    std::cout << "options --> periodic_compaction_seconds : " << FLAGS_periodic_compaction_seconds << std::endl;
+    std::cout << "options --> enable_blob_files : " << (FLAGS_enable_blob_files ? "true" : "false") << std::endl;
+    if (FLAGS_enable_blob_files) {
+        std::cout << "options --> min_blob_size     : " << FLAGS_min_blob_size << "B" << std::endl;
+        std::cout << "options --> blob_file_size    : " << FLAGS_blob_file_size << "MB" << std::endl;
+        std::cout << "options --> enable_blob_gc    : " << (FLAGS_enable_blob_gc ? "true" : "false") << std::endl;
+        std::cout << "options --> blob_gc_age_cutoff      : " << FLAGS_blob_gc_age_cutoff << std::endl;
+        std::cout << "options --> blob_gc_force_threshold : " << FLAGS_blob_gc_force_threshold << std::endl;
+    }
+    if (FLAGS_shared_cache_mb > 0) {
+        std::cout << "options --> shared_cache      : " << FLAGS_shared_cache_mb << "MB " << FLAGS_cache_type
+                  << " cache, shard bits " << FLAGS_cache_shard_bits << std::endl;
+    } else {
+        std::cout << "options --> shared_cache      : none, 1GB cache per column family" << std::endl;
+    }
+    std::cout << "options --> write_buffer_manager : " << FLAGS_write_buffer_manager_mb << "MB" << std::endl;
+    std::cout << "options --> rate_limit        : " << FLAGS_rate_limit_mb << "MB/s"
+              << (FLAGS_rate_limit_auto_tune ? " (auto tune)" : "") << std::endl;
+    std::cout << "options --> io_accounting     : " << (FLAGS_io_accounting ? "true" : "false") << std::endl;
+    if (ParseIoShapingOptions().Enabled()) {
+        std::cout << std::endl;
+        std::cout << "io shaping --> latency distribution : " << FLAGS_io_latency_distribution << std::endl;
+        std::cout << "io shaping --> read/write/sync latency : " << FLAGS_io_read_latency_us << "us/"
+                  << FLAGS_io_write_latency_us << "us/" << FLAGS_io_sync_latency_us << "us" << std::endl;
+        std::cout << "io shaping --> wal/sst/manifest bandwidth : " << FLAGS_io_wal_bandwidth_mb << "MB/s/"
+                  << FLAGS_io_sst_bandwidth_mb << "MB/s/" << FLAGS_io_manifest_bandwidth_mb << "MB/s" << std::endl;
+        std::cout << "io shaping --> spike interval/duration/latency : " << FLAGS_io_spike_interval_ms << "ms/"
+                  << FLAGS_io_spike_duration_ms << "ms/" << FLAGS_io_spike_latency_us << "us" << std::endl;
+    }
 
 }
 
 
 int main(int argc, char *argv[]) {
     ParseCommandLineFlags(&argc, &argv, true);
+    if (ParseTxnMode(FLAGS_txn) != TXN_NONE && !FLAGS_ttl_seconds.empty()) {
+        std::cout << "Error of params, --txn and --ttl_seconds can't be used together" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_prefix_size <= 0 && (FLAGS_index_type == "hash" || FLAGS_memtable_prefix_bloom_size_ratio > 0)) {
+        std::cout << "Error of params, --index_type=hash and --memtable_prefix_bloom_size_ratio need --prefix_size"
+                  << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_key_prefix_num > 0
+        && std::to_string(FLAGS_key_prefix_num - 1).size() > size_t(std::max(FLAGS_prefix_size, 0))) {
+        std::cout << "Error of params, --prefix_size is shorter than the digits of --key_prefix_num" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_table_format == "plain" && FLAGS_env != "default") {
+        std::cout << "Error of params, --table_format=plain reads by mmap, use --env=default" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_metrics_threads <= 0 || FLAGS_metrics_interval_ms <= 0) {
+        std::cout << "Error of params, --metrics_threads and --metrics_interval_ms must be positive" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_perf_sample_every < 0) {
+        std::cout << "Error of params, --perf_sample_every can't be negative" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_thread_sample_interval_ms <= 0) {
+        std::cout << "Error of params, --thread_sample_interval_ms must be positive" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_trace_events < 0) {
+        std::cout << "Error of params, --trace_events can't be negative" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_slow_ops_per_thread < 0 || FLAGS_slow_op_threshold_us < 0) {
+        std::cout << "Error of params, --slow_ops_per_thread and --slow_op_threshold_us can't be negative" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_tsdb_interval_ms <= 0 || FLAGS_tsdb_chunk_seconds <= 0) {
+        std::cout << "Error of params, --tsdb_interval_ms and --tsdb_chunk_seconds must be positive" << std::endl;
+        exit(-1);
+    }
+    if (FLAGS_scrape_min_interval_ms < 0) {
+        std::cout << "Error of params, --scrape_min_interval_ms can't be negative" << std::endl;
+        exit(-1);
+    }
     PrintCommandLine();
+
+    // ctrl-c/kill stops the benchmarks, the threads started from here on leave the signals to the waiter
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
     std::string prometheus_host = std::string("0.0.0.0:") + std::to_string(FLAGS_prometheus_port);
     TestRocksDB db("./testdb", prometheus_host);
+    std::thread([&db, stop_signals] {
+        int sig = 0;
+        sigwait(&stop_signals, &sig);
+        std::cout << "stopping the benchmarks by signal " << sig << ", again to exit at once" << std::endl;
+        db.Stop();
+        // the stop may hang behind a write stop or a long compaction
+        sigwait(&stop_signals, &sig);
+        std::cout << "exiting by signal " << sig << std::endl;
+        _exit(1);
+    }).detach();
     db.RunTest(FLAGS_rocksdb_num, FLAGS_rocksdb_columns);
-
+    db.DumpTrace();
+    db.DumpSlowOps();
+    db.StopTsdbRecorder();
 
     return 0;
 }
@@ -0,0 +1,179 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+/*
+ * Cost of one metrics flush of 100 rocksdbs with 10 column families each:
+ *   BM_FlushMetrics         -- RocksdbStatistics::FlushMetrics of every rocksdb, in a mem env
+ *   BM_TickersLabelLookup   -- the tickers of every rocksdb through WithLabelValues on each flush
+ *   BM_TickersCachedHandles -- the same tickers through counters resolved once
+ *   BM_ListenerEvents       -- a flush and a compaction event of every column family
+ *
+ * metrics_bench --benchmark_repetitions=3
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <rocksdb/db.h>
+#include <rocksdb/env.h>
+#include <rocksdb/options.h>
+#include <rocksdb/statistics.h>
+#include "rocksdb_metrics.hh"
+#include "prometheus/counter.h"
+
+static const int DB_NUM = 100;
+static const int CF_NUM = 10;
+// about the tickers RocksdbStatistics exports
+static const int TICKER_NUM = 68;
+
+struct BenchDB {
+    std::string name;
+    std::unique_ptr<rocksdb::DB> db;
+    std::vector<rocksdb::ColumnFamilyHandle *> cfs;
+};
+
+// DB_NUM rocksdbs of CF_NUM column families with one sst each, opened once for every benchmark
+class BenchDBs {
+public:
+    static BenchDBs &Get() {
+        static BenchDBs dbs;
+        return dbs;
+    }
+
+    std::vector<BenchDB> dbs;
+
+private:
+    BenchDBs() : env_(rocksdb::NewMemEnv(rocksdb::Env::Default())) {
+        for (int i = 0; i < DB_NUM; i++) {
+            rocksdb::Options options;
+            options.create_if_missing = true;
+            options.create_missing_column_families = true;
+            options.env = env_.get();
+            options.statistics = rocksdb::CreateDBStatistics();
+            std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
+            column_families.push_back(rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, options));
+            for (int j = 1; j < CF_NUM; j++) {
+                column_families.push_back(rocksdb::ColumnFamilyDescriptor(std::to_string(j), options));
+            }
+
+            BenchDB bench_db;
+            bench_db.name = "rocks" + std::to_string(i);
+            rocksdb::DB *db = nullptr;
+            auto s = rocksdb::DB::Open(options, "/bench/" + bench_db.name, column_families, &bench_db.cfs, &db);
+            if (!s.ok()) {
+                std::cout << "Error of open rocksdb: " << s.ToString() << std::endl;
+                exit(-1);
+            }
+            bench_db.db.reset(db);
+            for (auto cf : bench_db.cfs) {
+                for (int k = 0; k < 100; k++) {
+                    db->Put(rocksdb::WriteOptions(), cf, std::to_string(k), std::string(100, 'v'));
+                }
+                db->Flush(rocksdb::FlushOptions(), cf);
+            }
+            dbs.push_back(std::move(bench_db));
+        }
+    }
+
+    ~BenchDBs() {
+        for (auto &bench_db : dbs) {
+            for (auto cf : bench_db.cfs) {
+                bench_db.db->DestroyColumnFamilyHandle(cf);
+            }
+            bench_db.db.reset();
+        }
+    }
+
+    std::unique_ptr<rocksdb::Env> env_;
+};
+
+static void BM_FlushMetrics(benchmark::State &state) {
+    auto &bench_dbs = BenchDBs::Get();
+    RocksdbStatistics statistics;
+    for (auto _ : state) {
+        for (auto &bench_db : bench_dbs.dbs) {
+            statistics.FlushMetrics(*bench_db.db, bench_db.name, bench_db.cfs);
+        }
+    }
+    state.counters["dbs"] = DB_NUM;
+    state.counters["cfs"] = DB_NUM * CF_NUM;
+}
+
+BENCHMARK(BM_FlushMetrics)->Unit(benchmark::kMillisecond);
+
+static std::vector<std::string> TickerTypes() {
+    std::vector<std::string> types;
+    for (int i = 0; i < TICKER_NUM; i++) {
+        types.push_back("ticker_" + std::to_string(i));
+    }
+    return types;
+}
+
+static void BM_TickersLabelLookup(benchmark::State &state) {
+    prometheus::Registry registry;
+    auto &family = prometheus::BuildCounter()
+            .Name("bench_ticker")
+            .Help("bench ticker")
+            .LabelNamesVec({"db", "type"})
+            .Register(registry);
+    auto types = TickerTypes();
+    for (auto _ : state) {
+        for (int i = 0; i < DB_NUM; i++) {
+            auto name = "rocks" + std::to_string(i);
+            for (auto &type : types) {
+                family.WithLabelValues({name, type}).Increment(1);
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_TickersLabelLookup)->Unit(benchmark::kMicrosecond);
+
+static void BM_TickersCachedHandles(benchmark::State &state) {
+    prometheus::Registry registry;
+    auto &family = prometheus::BuildCounter()
+            .Name("bench_ticker")
+            .Help("bench ticker")
+            .LabelNamesVec({"db", "type"})
+            .Register(registry);
+    std::vector<prometheus::Counter *> counters;
+    for (int i = 0; i < DB_NUM; i++) {
+        for (auto &type : TickerTypes()) {
+            counters.push_back(&family.WithLabelValues({"rocks" + std::to_string(i), type}));
+        }
+    }
+    for (auto _ : state) {
+        for (auto counter : counters) {
+            counter->Increment(1);
+        }
+    }
+}
+
+BENCHMARK(BM_TickersCachedHandles)->Unit(benchmark::kMicrosecond);
+
+static void BM_ListenerEvents(benchmark::State &state) {
+    RocksdbStatistics statistics;
+    std::vector<std::unique_ptr<StatisticsEventListener>> listeners;
+    for (int i = 0; i < DB_NUM; i++) {
+        listeners.emplace_back(new StatisticsEventListener("rocks" + std::to_string(i), statistics));
+    }
+    rocksdb::FlushJobInfo flush_info;
+    rocksdb::CompactionJobInfo compaction_info;
+    compaction_info.output_level = 1;
+    for (auto _ : state) {
+        for (auto &listener : listeners) {
+            for (int j = 0; j < CF_NUM; j++) {
+                flush_info.cf_name = std::to_string(j);
+                compaction_info.cf_name = flush_info.cf_name;
+                listener->OnFlushCompleted(nullptr, flush_info);
+                listener->OnCompactionCompleted(nullptr, compaction_info);
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_ListenerEvents)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include "metrics_scheduler.hh"
+
+MetricsScheduler::MetricsScheduler(int threads)
+        : next_(0), round_size_(0), pending_(0), stop_(false) {
+    for (int i = 0; i < threads; i++) {
+        workers_.push_back(std::thread(std::bind(&MetricsScheduler::Work, this)));
+    }
+}
+
+MetricsScheduler::~MetricsScheduler() {
+    Stop();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void MetricsScheduler::Add(const std::function<void()> &task) {
+    std::lock_guard<std::mutex> round_lock(round_mutex_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(task);
+}
+
+void MetricsScheduler::RunOnce() {
+    std::lock_guard<std::mutex> round_lock(round_mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stop_) {
+        return;
+    }
+    next_ = 0;
+    round_size_ = tasks_.size();
+    pending_ = tasks_.size();
+    work_cv_.notify_all();
+    done_cv_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void MetricsScheduler::Start(std::chrono::milliseconds period) {
+    timer_ = std::thread(std::bind(&MetricsScheduler::Timer, this, period));
+}
+
+void MetricsScheduler::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    stop_cv_.notify_all();
+    if (timer_.joinable()) {
+        timer_.join();
+    }
+}
+
+void MetricsScheduler::Work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // the tasks of a started round are finished even if stopped, RunOnce waits for them
+        work_cv_.wait(lock, [this] { return next_ < round_size_ || stop_; });
+        if (next_ >= round_size_) {
+            return;
+        }
+        auto task = tasks_[next_++];
+        lock.unlock();
+        task();
+        lock.lock();
+        if (--pending_ == 0) {
+            done_cv_.notify_all();
+        }
+    }
+}
+
+void MetricsScheduler::Timer(std::chrono::milliseconds period) {
+    while (true) {
+        auto next_time = std::chrono::steady_clock::now() + period;
+        RunOnce();
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_cv_.wait_until(lock, next_time, [this] { return stop_; })) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*
+ * Runs every added task (e.g. the metrics flush of one rocksdb) once a period on a small pool of
+ * threads, so all the rocksdbs are sampled at about the same time instead of one after another.
+ * A round waits for all its tasks, a round taking longer than the period starts the next at once.
+ */
+class MetricsScheduler {
+public:
+    explicit MetricsScheduler(int threads);
+
+    ~MetricsScheduler();
+
+    void Add(const std::function<void()> &task);
+
+    // runs every task once in the pool and waits for them, rounds of concurrent callers are serialized
+    void RunOnce();
+
+    // a round every period in a timer thread until Stop
+    void Start(std::chrono::milliseconds period);
+
+    void Stop();
+
+private:
+    void Work();
+
+    void Timer(std::chrono::milliseconds period);
+
+    std::mutex round_mutex_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::condition_variable stop_cv_;
+    std::vector<std::function<void()>> tasks_;
+    // tasks_[next_, round_size_) are not taken yet, pending_ are not finished
+    size_t next_;
+    size_t round_size_;
+    size_t pending_;
+    bool stop_;
+    std::vector<std::thread> workers_;
+    std::thread timer_;
+};
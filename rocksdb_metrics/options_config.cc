@@ -0,0 +1,651 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <rocksdb/cache.h>
+#include <rocksdb/convenience.h>
+#include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/table.h>
+#include <rocksdb/utilities/options_util.h>
+#include "options_config.hh"
+
+const YamlNode *YamlNode::Find(const std::string &child_key) const {
+    for (auto &child : children) {
+        if (child.key == child_key) {
+            return &child;
+        }
+    }
+    return nullptr;
+}
+
+static std::string Trim(const std::string &str) {
+    auto begin = str.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    auto end = str.find_last_not_of(" \t\r");
+    return str.substr(begin, end - begin + 1);
+}
+
+static std::string Unquote(const std::string &str) {
+    if (str.size() >= 2 && (str.front() == '"' || str.front() == '\'') && str.back() == str.front()) {
+        return str.substr(1, str.size() - 2);
+    }
+    return str;
+}
+
+// a # outside quotes at the line start or after a space starts a comment
+static std::string StripComment(const std::string &line) {
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        auto c = line[i];
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '#' && (i == 0 || line[i - 1] == ' ' || line[i - 1] == '\t')) {
+            return line.substr(0, i);
+        }
+    }
+    return line;
+}
+
+// the colon of "key: value" or "key:", outside quotes
+static size_t FindKeyColon(const std::string &content) {
+    char quote = 0;
+    for (size_t i = 0; i < content.size(); i++) {
+        auto c = content[i];
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == ':' && (i + 1 == content.size() || content[i + 1] == ' ')) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+static bool ParseFlowSequence(const std::string &value, std::vector<std::string> *items) {
+    if (value.size() < 2 || value.front() != '[' || value.back() != ']') {
+        return false;
+    }
+    auto body = value.substr(1, value.size() - 2);
+    if (Trim(body).empty()) {
+        return true;
+    }
+    char quote = 0;
+    std::string item;
+    for (auto c : body) {
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == ',') {
+            items->push_back(Unquote(Trim(item)));
+            item.clear();
+            continue;
+        }
+        item.push_back(c);
+    }
+    items->push_back(Unquote(Trim(item)));
+    return true;
+}
+
+rocksdb::Status ParseYaml(const std::string &text, YamlNode *root) {
+    *root = YamlNode();
+    // open mappings from the root to the current line, with the indent of their key
+    std::vector<std::pair<int, YamlNode *>> stack{{-1, root}};
+    std::istringstream in(text);
+    std::string raw;
+    int line_no = 0;
+
+    while (std::getline(in, raw)) {
+        line_no++;
+        auto line = StripComment(raw);
+        auto content = Trim(line);
+        if (content.empty() || content == "---" || content == "...") {
+            continue;
+        }
+        auto indent = int(line.find_first_not_of(' '));
+        if (line[indent] == '\t') {
+            return rocksdb::Status::InvalidArgument("line " + std::to_string(line_no) + ": tab indent");
+        }
+
+        if (content == "-" || content.compare(0, 2, "- ") == 0) {
+            while (stack.size() > 1 && stack.back().first > indent) {
+                stack.pop_back();
+            }
+            auto parent = stack.back().second;
+            if (parent == root || !parent->children.empty()) {
+                return rocksdb::Status::InvalidArgument(
+                        "line " + std::to_string(line_no) + ": sequence item outside a sequence");
+            }
+            parent->items.push_back(Unquote(Trim(content.substr(1))));
+            continue;
+        }
+
+        auto colon = FindKeyColon(content);
+        if (colon == std::string::npos) {
+            return rocksdb::Status::InvalidArgument(
+                    "line " + std::to_string(line_no) + ": expect \"key: value\", got " + content);
+        }
+        while (stack.back().first >= indent) {
+            stack.pop_back();
+        }
+        auto parent = stack.back().second;
+        if (!parent->items.empty()) {
+            return rocksdb::Status::InvalidArgument(
+                    "line " + std::to_string(line_no) + ": mapping inside a sequence");
+        }
+
+        YamlNode node;
+        node.key = Unquote(Trim(content.substr(0, colon)));
+        auto value = Trim(content.substr(colon + 1));
+        if (!value.empty() && value.front() == '[') {
+            if (!ParseFlowSequence(value, &node.items)) {
+                return rocksdb::Status::InvalidArgument(
+                        "line " + std::to_string(line_no) + ": unterminated sequence " + value);
+            }
+        } else {
+            node.value = Unquote(value);
+        }
+        parent->children.push_back(node);
+        if (value.empty()) {
+            stack.push_back(std::make_pair(indent, &parent->children.back()));
+        }
+    }
+    return rocksdb::Status::OK();
+}
+
+
+// "512KB", "25GB", "0" to bytes
+static bool ParseSize(const std::string &value, uint64_t *bytes) {
+    std::istringstream in(value);
+    double number = 0;
+    if (!(in >> number) || number < 0) {
+        return false;
+    }
+    std::string unit;
+    in >> unit;
+    std::transform(unit.begin(), unit.end(), unit.begin(), ::toupper);
+    static const std::vector<std::pair<std::string, uint64_t>> units{
+            {"", 1}, {"B", 1},
+            {"K", 1ull << 10}, {"KB", 1ull << 10}, {"KIB", 1ull << 10},
+            {"M", 1ull << 20}, {"MB", 1ull << 20}, {"MIB", 1ull << 20},
+            {"G", 1ull << 30}, {"GB", 1ull << 30}, {"GIB", 1ull << 30},
+            {"T", 1ull << 40}, {"TB", 1ull << 40}, {"TIB", 1ull << 40},
+    };
+    for (auto &pair : units) {
+        if (pair.first == unit) {
+            *bytes = uint64_t(number * pair.second);
+            return true;
+        }
+    }
+    return false;
+}
+
+// "10m", "1h30m", "60s", "0" to seconds
+static bool ParseDuration(const std::string &value, uint64_t *seconds) {
+    std::istringstream in(value);
+    double total = 0;
+    double number = 0;
+    while (in >> number) {
+        std::string unit;
+        while (std::isalpha(in.peek())) {
+            unit.push_back(char(in.get()));
+        }
+        if (unit.empty() || unit == "s") {
+            total += number;
+        } else if (unit == "ms") {
+            total += number / 1000;
+        } else if (unit == "m") {
+            total += number * 60;
+        } else if (unit == "h") {
+            total += number * 3600;
+        } else if (unit == "d") {
+            total += number * 86400;
+        } else {
+            return false;
+        }
+    }
+    if (!in.eof()) {
+        return false;
+    }
+    *seconds = uint64_t(total);
+    return true;
+}
+
+static bool ParseBool(const std::string &value, bool *result) {
+    if (value == "true") {
+        *result = true;
+    } else if (value == "false") {
+        *result = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// yaml enum value, the rocksdb name (kMinOverlappingRatio) or its index
+static bool ParseEnum(const std::string &value, const std::vector<std::string> &names, std::string *result) {
+    if (std::find(names.begin(), names.end(), value) != names.end()) {
+        *result = value;
+        return true;
+    }
+    std::istringstream in(value);
+    size_t index = 0;
+    if (!(in >> index) || !in.eof() || index >= names.size()) {
+        return false;
+    }
+    *result = names[index];
+    return true;
+}
+
+static bool ParseCompression(const std::string &value, std::string *result) {
+    static const std::vector<std::pair<std::string, std::string>> compressions{
+            {"no",     "kNoCompression"},
+            {"snappy", "kSnappyCompression"},
+            {"zlib",   "kZlibCompression"},
+            {"bzip2",  "kBZip2Compression"},
+            {"lz4",    "kLZ4Compression"},
+            {"lz4hc",  "kLZ4HCCompression"},
+            {"zstd",   "kZSTD"},
+    };
+    for (auto &pair : compressions) {
+        if (pair.first == value || pair.second == value) {
+            *result = pair.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+enum OptionTarget {
+    TARGET_DB, TARGET_CF, TARGET_TABLE
+};
+
+enum OptionValue {
+    VALUE_RAW, VALUE_BOOL, VALUE_SIZE, VALUE_SIZE_MB, VALUE_DURATION,
+    VALUE_WAL_RECOVERY_MODE, VALUE_COMPACTION_PRI, VALUE_COMPRESSION_LIST
+};
+
+struct OptionMapping {
+    const char *key;
+    OptionTarget target;
+    const char *option;
+    OptionValue value;
+};
+
+// yaml key -> rocksdb option name, the value is converted to the rocksdb option string
+static const OptionMapping kOptionMappings[] = {
+        {"max-background-jobs",                    TARGET_DB,    "max_background_jobs",                    VALUE_RAW},
+        {"max-background-flushes",                 TARGET_DB,    "max_background_flushes",                 VALUE_RAW},
+        {"max-background-compactions",             TARGET_DB,    "max_background_compactions",             VALUE_RAW},
+        {"max-sub-compactions",                    TARGET_DB,    "max_subcompactions",                     VALUE_RAW},
+        {"max-open-files",                         TARGET_DB,    "max_open_files",                         VALUE_RAW},
+        {"max-manifest-file-size",                 TARGET_DB,    "max_manifest_file_size",                 VALUE_SIZE},
+        {"create-if-missing",                      TARGET_DB,    "create_if_missing",                      VALUE_BOOL},
+        {"wal-recovery-mode",                      TARGET_DB,    "wal_recovery_mode",                      VALUE_WAL_RECOVERY_MODE},
+        {"wal-dir",                                TARGET_DB,    "wal_dir",                                VALUE_RAW},
+        {"wal-ttl-seconds",                        TARGET_DB,    "WAL_ttl_seconds",                        VALUE_RAW},
+        {"wal-size-limit",                         TARGET_DB,    "WAL_size_limit_MB",                      VALUE_SIZE_MB},
+        {"max-total-wal-size",                     TARGET_DB,    "max_total_wal_size",                     VALUE_SIZE},
+        {"stats-dump-period",                      TARGET_DB,    "stats_dump_period_sec",                  VALUE_DURATION},
+        {"compaction-readahead-size",              TARGET_DB,    "compaction_readahead_size",              VALUE_SIZE},
+        {"writable-file-max-buffer-size",          TARGET_DB,    "writable_file_max_buffer_size",          VALUE_SIZE},
+        {"use-direct-io-for-flush-and-compaction", TARGET_DB,    "use_direct_io_for_flush_and_compaction", VALUE_BOOL},
+        {"enable-pipelined-write",                 TARGET_DB,    "enable_pipelined_write",                 VALUE_BOOL},
+        {"allow-concurrent-memtable-write",        TARGET_DB,    "allow_concurrent_memtable_write",        VALUE_BOOL},
+        {"bytes-per-sync",                         TARGET_DB,    "bytes_per_sync",                         VALUE_SIZE},
+        {"wal-bytes-per-sync",                     TARGET_DB,    "wal_bytes_per_sync",                     VALUE_SIZE},
+
+        {"compression-per-level",                  TARGET_CF,    "compression_per_level",                  VALUE_COMPRESSION_LIST},
+        {"write-buffer-size",                      TARGET_CF,    "write_buffer_size",                      VALUE_SIZE},
+        {"max-write-buffer-number",                TARGET_CF,    "max_write_buffer_number",                VALUE_RAW},
+        {"min-write-buffer-number-to-merge",       TARGET_CF,    "min_write_buffer_number_to_merge",       VALUE_RAW},
+        {"max-bytes-for-level-base",               TARGET_CF,    "max_bytes_for_level_base",               VALUE_SIZE},
+        {"max-bytes-for-level-multiplier",         TARGET_CF,    "max_bytes_for_level_multiplier",         VALUE_RAW},
+        {"target-file-size-base",                  TARGET_CF,    "target_file_size_base",                  VALUE_SIZE},
+        {"max-compaction-bytes",                   TARGET_CF,    "max_compaction_bytes",                   VALUE_SIZE},
+        {"level0-file-num-compaction-trigger",     TARGET_CF,    "level0_file_num_compaction_trigger",     VALUE_RAW},
+        {"level0-slowdown-writes-trigger",         TARGET_CF,    "level0_slowdown_writes_trigger",         VALUE_RAW},
+        {"level0-stop-writes-trigger",             TARGET_CF,    "level0_stop_writes_trigger",             VALUE_RAW},
+        {"compaction-pri",                         TARGET_CF,    "compaction_pri",                         VALUE_COMPACTION_PRI},
+        {"dynamic-level-bytes",                    TARGET_CF,    "level_compaction_dynamic_level_bytes",   VALUE_BOOL},
+        {"num-levels",                             TARGET_CF,    "num_levels",                             VALUE_RAW},
+        {"disable-auto-compactions",               TARGET_CF,    "disable_auto_compactions",               VALUE_BOOL},
+        {"soft-pending-compaction-bytes-limit",    TARGET_CF,    "soft_pending_compaction_bytes_limit",    VALUE_SIZE},
+        {"hard-pending-compaction-bytes-limit",    TARGET_CF,    "hard_pending_compaction_bytes_limit",    VALUE_SIZE},
+
+        {"block-size",                             TARGET_TABLE, "block_size",                             VALUE_SIZE},
+        {"cache-index-and-filter-blocks",          TARGET_TABLE, "cache_index_and_filter_blocks",          VALUE_BOOL},
+        {"pin-l0-filter-and-index-blocks",         TARGET_TABLE, "pin_l0_filter_and_index_blocks_in_cache", VALUE_BOOL},
+        {"read-amp-bytes-per-bit",                 TARGET_TABLE, "read_amp_bytes_per_bit",                 VALUE_RAW},
+        {"whole-key-filtering",                    TARGET_TABLE, "whole_key_filtering",                    VALUE_BOOL},
+        {"format-version",                         TARGET_TABLE, "format_version",                         VALUE_RAW},
+};
+
+static const OptionMapping *FindOptionMapping(const std::string &key, bool column_family) {
+    for (auto &mapping : kOptionMappings) {
+        if (key == mapping.key && (mapping.target == TARGET_DB) != column_family) {
+            return &mapping;
+        }
+    }
+    return nullptr;
+}
+
+static bool ConvertOptionValue(const YamlNode &node, OptionValue value, std::string *result) {
+    if (value == VALUE_COMPRESSION_LIST) {
+        result->clear();
+        for (auto &item : node.items) {
+            std::string compression;
+            if (!ParseCompression(item, &compression)) {
+                return false;
+            }
+            *result += (result->empty() ? "" : ":") + compression;
+        }
+        return !node.items.empty();
+    }
+    if (!node.items.empty()) {
+        return false;
+    }
+
+    uint64_t number = 0;
+    bool flag = false;
+    switch (value) {
+        case VALUE_RAW:
+            *result = node.value;
+            return true;
+        case VALUE_BOOL:
+            if (!ParseBool(node.value, &flag)) {
+                return false;
+            }
+            *result = flag ? "true" : "false";
+            return true;
+        case VALUE_SIZE:
+            if (!ParseSize(node.value, &number)) {
+                return false;
+            }
+            *result = std::to_string(number);
+            return true;
+        case VALUE_SIZE_MB:
+            if (!ParseSize(node.value, &number)) {
+                return false;
+            }
+            *result = std::to_string(number >> 20);
+            return true;
+        case VALUE_DURATION:
+            if (!ParseDuration(node.value, &number)) {
+                return false;
+            }
+            *result = std::to_string(number);
+            return true;
+        case VALUE_WAL_RECOVERY_MODE:
+            return ParseEnum(node.value, {"kTolerateCorruptedTailRecords", "kAbsoluteConsistency",
+                                          "kPointInTimeRecovery", "kSkipAnyCorruptedRecords"}, result);
+        case VALUE_COMPACTION_PRI:
+            return ParseEnum(node.value, {"kByCompensatedSize", "kOldestLargestSeqFirst",
+                                          "kOldestSmallestSeqFirst", "kMinOverlappingRatio"}, result);
+        default:
+            return false;
+    }
+}
+
+static rocksdb::Status AppendOption(const std::string &path, const YamlNode &node,
+                                    const OptionMapping &mapping, std::string *opts) {
+    std::string value;
+    if (!ConvertOptionValue(node, mapping.value, &value)) {
+        return rocksdb::Status::InvalidArgument("invalid value of " + path + "." + node.key, node.value);
+    }
+    *opts += std::string(mapping.option) + "=" + value + ";";
+    return rocksdb::Status::OK();
+}
+
+// defaultcf -> default, writecf -> write
+static std::string ColumnFamilyName(const std::string &key) {
+    if (key == "defaultcf" || key == rocksdb::kDefaultColumnFamilyName) {
+        return rocksdb::kDefaultColumnFamilyName;
+    }
+    if (key.size() > 2 && key.compare(key.size() - 2, 2, "cf") == 0) {
+        return key.substr(0, key.size() - 2);
+    }
+    return key;
+}
+
+static rocksdb::Status LoadColumnFamilyConfig(const std::string &path, const YamlNode &node,
+                                              const rocksdb::ColumnFamilyOptions &base_cf_options,
+                                              const rocksdb::BlockBasedTableOptions &base_table_options,
+                                              ColumnFamilyConfig *cf_config) {
+    std::string cf_opts;
+    std::string table_opts;
+    uint64_t block_cache_size = base_table_options.block_cache ?
+                                base_table_options.block_cache->GetCapacity() : 8ull << 20;
+    bool bloom = false;
+    double bloom_bits_per_key = 10;
+    bool block_based_bloom = false;
+
+    for (auto &child : node.children) {
+        rocksdb::Status s;
+        if (child.key == "block-cache-size") {
+            if (!ParseSize(child.value, &block_cache_size)) {
+                return rocksdb::Status::InvalidArgument("invalid value of " + path + "." + child.key, child.value);
+            }
+            continue;
+        } else if (child.key == "bloom-filter-bits-per-key") {
+            std::istringstream in(child.value);
+            if (!(in >> bloom_bits_per_key)) {
+                return rocksdb::Status::InvalidArgument("invalid value of " + path + "." + child.key, child.value);
+            }
+            bloom = true;
+            continue;
+        } else if (child.key == "block-based-bloom-filter") {
+            if (!ParseBool(child.value, &block_based_bloom)) {
+                return rocksdb::Status::InvalidArgument("invalid value of " + path + "." + child.key, child.value);
+            }
+            bloom = true;
+            continue;
+        }
+
+        auto mapping = FindOptionMapping(child.key, true);
+        if (mapping == nullptr) {
+            std::cout << "config: ignore unknown option " << path << "." << child.key << std::endl;
+            continue;
+        }
+        s = AppendOption(path, child, *mapping, mapping->target == TARGET_TABLE ? &table_opts : &cf_opts);
+        if (!s.ok()) {
+            return s;
+        }
+    }
+
+    rocksdb::ConfigOptions config_options;
+    config_options.ignore_unknown_options = false;
+    config_options.input_strings_escaped = false;
+    auto s = rocksdb::GetColumnFamilyOptionsFromString(config_options, base_cf_options, cf_opts,
+                                                       &cf_config->options);
+    if (!s.ok()) {
+        return s;
+    }
+    rocksdb::BlockBasedTableOptions table_options;
+    s = rocksdb::GetBlockBasedTableOptionsFromString(config_options, base_table_options, table_opts,
+                                                     &table_options);
+    if (!s.ok()) {
+        return s;
+    }
+    // every column family of the config owns its block cache, as the kv server does
+    table_options.block_cache = rocksdb::NewLRUCache(block_cache_size);
+    if (bloom) {
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(bloom_bits_per_key, block_based_bloom));
+    }
+    cf_config->options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+    cf_config->name = ColumnFamilyName(node.key);
+    return rocksdb::Status::OK();
+}
+
+static rocksdb::Status LoadYamlConfig(const std::string &path, const std::string &section,
+                                      const rocksdb::DBOptions &base_db_options,
+                                      const rocksdb::ColumnFamilyOptions &base_cf_options,
+                                      OptionsConfig *config) {
+    std::ifstream in(path);
+    if (!in) {
+        return rocksdb::Status::IOError("can't open " + path);
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    YamlNode root;
+    auto s = ParseYaml(text.str(), &root);
+    if (!s.ok()) {
+        return rocksdb::Status::InvalidArgument(path, s.ToString());
+    }
+    auto db_node = root.Find(section);
+    if (db_node == nullptr) {
+        return rocksdb::Status::NotFound("no section " + section + " in " + path);
+    }
+
+    std::string db_opts;
+    std::vector<const YamlNode *> cf_nodes;
+    for (auto &child : db_node->children) {
+        if (!child.children.empty()) {
+            cf_nodes.push_back(&child);
+            continue;
+        }
+        if (child.key == "rate-bytes-per-sec") {
+            uint64_t rate_bytes_per_sec = 0;
+            if (!ParseSize(child.value, &rate_bytes_per_sec)) {
+                return rocksdb::Status::InvalidArgument("invalid value of " + section + "." + child.key,
+                                                        child.value);
+            }
+            config->rate_bytes_per_sec = rate_bytes_per_sec;
+            continue;
+        } else if (child.key == "enable-statistics") {
+            // the metrics are built on the statistics, it's always enabled
+            continue;
+        }
+
+        auto mapping = FindOptionMapping(child.key, false);
+        if (mapping == nullptr) {
+            std::cout << "config: ignore unknown option " << section << "." << child.key << std::endl;
+            continue;
+        }
+        s = AppendOption(section, child, *mapping, &db_opts);
+        if (!s.ok()) {
+            return s;
+        }
+    }
+
+    rocksdb::ConfigOptions config_options;
+    config_options.ignore_unknown_options = false;
+    config_options.input_strings_escaped = false;
+    s = rocksdb::GetDBOptionsFromString(config_options, base_db_options, db_opts, &config->db_options);
+    if (!s.ok()) {
+        return s;
+    }
+
+    rocksdb::BlockBasedTableOptions base_table_options;
+    if (base_cf_options.table_factory) {
+        auto table_options = base_cf_options.table_factory->GetOptions<rocksdb::BlockBasedTableOptions>();
+        if (table_options != nullptr) {
+            base_table_options = *table_options;
+        }
+    }
+    config->column_families.clear();
+    for (auto cf_node : cf_nodes) {
+        ColumnFamilyConfig cf_config;
+        s = LoadColumnFamilyConfig(section + "." + cf_node->key, *cf_node, base_cf_options,
+                                   base_table_options, &cf_config);
+        if (!s.ok()) {
+            return s;
+        }
+        config->column_families.push_back(cf_config);
+    }
+    return rocksdb::Status::OK();
+}
+
+static rocksdb::Status LoadNativeConfig(const std::string &path, OptionsConfig *config) {
+    rocksdb::ConfigOptions config_options;
+    config_options.ignore_unknown_options = false;
+    std::vector<rocksdb::ColumnFamilyDescriptor> cf_descs;
+    auto s = rocksdb::LoadOptionsFromFile(config_options, path, &config->db_options, &cf_descs);
+    if (!s.ok()) {
+        return s;
+    }
+    config->column_families.clear();
+    for (auto &cf_desc : cf_descs) {
+        ColumnFamilyConfig cf_config;
+        cf_config.name = cf_desc.name;
+        cf_config.options = cf_desc.options;
+        config->column_families.push_back(cf_config);
+    }
+    return rocksdb::Status::OK();
+}
+
+static bool EndsWith(const std::string &str, const std::string &suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+rocksdb::Status LoadOptionsConfig(const std::string &path, const std::string &section,
+                                  const rocksdb::DBOptions &base_db_options,
+                                  const rocksdb::ColumnFamilyOptions &base_cf_options,
+                                  OptionsConfig *config) {
+    rocksdb::Status s;
+    if (EndsWith(path, ".yml") || EndsWith(path, ".yaml")) {
+        s = LoadYamlConfig(path, section, base_db_options, base_cf_options, config);
+    } else {
+        s = LoadNativeConfig(path, config);
+    }
+    if (!s.ok() || config->column_families.empty()) {
+        return s;
+    }
+
+    auto default_cf = std::find_if(config->column_families.begin(), config->column_families.end(),
+                                   [](const ColumnFamilyConfig &cf_config) {
+                                       return cf_config.name == rocksdb::kDefaultColumnFamilyName;
+                                   });
+    if (default_cf == config->column_families.end()) {
+        std::cout << "config: no default column family, " << config->column_families.front().name
+                  << " is used as it" << std::endl;
+        config->column_families.front().name = rocksdb::kDefaultColumnFamilyName;
+    } else {
+        std::rotate(config->column_families.begin(), default_cf, default_cf + 1);
+    }
+    return s;
+}
+
+rocksdb::Status OverrideOptionsConfig(const std::string &opts, OptionsConfig *config) {
+    if (opts.empty()) {
+        return rocksdb::Status::OK();
+    }
+    rocksdb::ConfigOptions config_options;
+    config_options.ignore_unknown_options = true;
+    config_options.input_strings_escaped = false;
+
+    rocksdb::DBOptions db_options;
+    auto s = rocksdb::GetDBOptionsFromString(config_options, config->db_options, opts, &db_options);
+    if (!s.ok()) {
+        return s;
+    }
+    config->db_options = db_options;
+    for (auto &cf_config : config->column_families) {
+        rocksdb::ColumnFamilyOptions cf_options;
+        s = rocksdb::GetColumnFamilyOptionsFromString(config_options, cf_config.options, opts, &cf_options);
+        if (!s.ok()) {
+            return s;
+        }
+        cf_config.options = cf_options;
+    }
+    return rocksdb::Status::OK();
+}
@@ -0,0 +1,54 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <rocksdb/options.h>
+#include <rocksdb/status.h>
+
+/*
+ * A node of a yaml document, the block style subset conf/rocksdb.yml is written in:
+ * nested mappings, scalars (plain or quoted), flow sequences ["a", "b"] and "- a" items.
+ */
+struct YamlNode {
+    std::string key;
+    std::string value;
+    std::vector<std::string> items;
+    // mapping entries in file order
+    std::vector<YamlNode> children;
+
+    const YamlNode *Find(const std::string &child_key) const;
+};
+
+rocksdb::Status ParseYaml(const std::string &text, YamlNode *root);
+
+
+struct ColumnFamilyConfig {
+    std::string name;
+    rocksdb::ColumnFamilyOptions options;
+};
+
+struct OptionsConfig {
+    rocksdb::DBOptions db_options;
+    // the rocksdb default column family is the first
+    std::vector<ColumnFamilyConfig> column_families;
+    // rate-bytes-per-sec of a yaml config, 0 means not limited
+    int64_t rate_bytes_per_sec = 0;
+};
+
+/*
+ * Path ending with .yml/.yaml is a kv config, the `section` (rocksdb/raftdb) of it is applied on
+ * the base options and every mapping under the section is a column family (defaultcf -> default,
+ * writecf -> write) with its own block cache and bloom filter.
+ * Any other path is a rocksdb OPTIONS file, loaded as it is.
+ */
+rocksdb::Status LoadOptionsConfig(const std::string &path, const std::string &section,
+                                  const rocksdb::DBOptions &base_db_options,
+                                  const rocksdb::ColumnFamilyOptions &base_cf_options,
+                                  OptionsConfig *config);
+
+// "name=value;..." applied on the db options and every column family, names of the other one are skipped
+rocksdb::Status OverrideOptionsConfig(const std::string &opts, OptionsConfig *config);
@@ -0,0 +1,139 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include "perf_sampler.hh"
+
+struct PerfStage {
+    const char *name;
+    uint64_t rocksdb::PerfContext::*field;
+};
+
+struct IOStatsStage {
+    const char *name;
+    uint64_t rocksdb::IOStatsContext::*field;
+};
+
+#define PERF_STAGE(field) {#field, &rocksdb::PerfContext::field}
+#define IOSTATS_STAGE(field) {"io_" #field, &rocksdb::IOStatsContext::field}
+
+static const PerfStage WRITE_STAGES[] = {
+        PERF_STAGE(write_thread_wait_nanos),
+        PERF_STAGE(write_scheduling_flushes_compactions_time),
+        PERF_STAGE(write_delay_time),
+        PERF_STAGE(write_wal_time),
+        PERF_STAGE(write_memtable_time),
+        PERF_STAGE(write_pre_and_post_process_time),
+        PERF_STAGE(db_mutex_lock_nanos),
+        PERF_STAGE(db_condition_wait_nanos),
+};
+
+static const PerfStage GET_STAGES[] = {
+        PERF_STAGE(get_snapshot_time),
+        PERF_STAGE(get_from_memtable_time),
+        PERF_STAGE(get_from_output_files_time),
+        PERF_STAGE(get_post_process_time),
+        PERF_STAGE(block_read_time),
+        PERF_STAGE(block_checksum_time),
+        PERF_STAGE(block_decompress_time),
+        PERF_STAGE(db_mutex_lock_nanos),
+};
+
+static const PerfStage SEEK_STAGES[] = {
+        PERF_STAGE(seek_on_memtable_time),
+        PERF_STAGE(seek_child_seek_time),
+        PERF_STAGE(seek_min_heap_time),
+        PERF_STAGE(seek_internal_seek_time),
+        PERF_STAGE(find_next_user_entry_time),
+        PERF_STAGE(block_read_time),
+        PERF_STAGE(block_decompress_time),
+};
+
+// key lock waits are rocksdb_txn_lock_wait_micros of every txn
+static const PerfStage TXN_STAGES[] = {
+        PERF_STAGE(get_from_memtable_time),
+        PERF_STAGE(get_from_output_files_time),
+        PERF_STAGE(block_read_time),
+        PERF_STAGE(write_thread_wait_nanos),
+        PERF_STAGE(write_delay_time),
+        PERF_STAGE(write_wal_time),
+        PERF_STAGE(write_memtable_time),
+        PERF_STAGE(db_mutex_lock_nanos),
+};
+
+static const IOStatsStage WRITE_IOSTATS_STAGES[] = {
+        IOSTATS_STAGE(write_nanos),
+        IOSTATS_STAGE(fsync_nanos),
+        IOSTATS_STAGE(range_sync_nanos),
+        IOSTATS_STAGE(prepare_write_nanos),
+};
+
+static const IOStatsStage READ_IOSTATS_STAGES[] = {
+        IOSTATS_STAGE(read_nanos),
+};
+
+#undef PERF_STAGE
+#undef IOSTATS_STAGE
+
+template <typename Stage, size_t N, typename Field>
+static void AddStages(prometheus::Family<prometheus::Histogram> &family, const std::string &type,
+                      const Stage (&stages)[N],
+                      std::vector<std::pair<Field, prometheus::Histogram *>> *handles) {
+    for (const auto &stage : stages) {
+        auto &histogram = family.WithLabelValues({type, stage.name});
+        handles->push_back(std::make_pair(stage.field, &histogram));
+    }
+}
+
+PerfSampler::PerfSampler(prometheus::Family<prometheus::Histogram> &family, const std::string &type,
+                         PerfStages stages, uint64_t sample_every)
+        : sample_every_(sample_every), count_(0), sampled_(false), level_(rocksdb::PerfLevel::kDisable) {
+    switch (stages) {
+        case PERF_WRITE:
+            AddStages(family, type, WRITE_STAGES, &perf_stages_);
+            AddStages(family, type, WRITE_IOSTATS_STAGES, &iostats_stages_);
+            break;
+        case PERF_GET:
+            AddStages(family, type, GET_STAGES, &perf_stages_);
+            AddStages(family, type, READ_IOSTATS_STAGES, &iostats_stages_);
+            break;
+        case PERF_SEEK:
+            AddStages(family, type, SEEK_STAGES, &perf_stages_);
+            AddStages(family, type, READ_IOSTATS_STAGES, &iostats_stages_);
+            break;
+        case PERF_TXN:
+            AddStages(family, type, TXN_STAGES, &perf_stages_);
+            AddStages(family, type, WRITE_IOSTATS_STAGES, &iostats_stages_);
+            AddStages(family, type, READ_IOSTATS_STAGES, &iostats_stages_);
+            break;
+    }
+}
+
+bool PerfSampler::Begin() {
+    if (sample_every_ == 0 || ++count_ % sample_every_ != 0) {
+        return false;
+    }
+    sampled_ = true;
+    level_ = rocksdb::GetPerfLevel();
+    // with the mutex timers, the db mutex waits are stages too
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableTime);
+    rocksdb::get_perf_context()->Reset();
+    rocksdb::get_iostats_context()->Reset();
+    return true;
+}
+
+void PerfSampler::End() {
+    if (!sampled_) {
+        return;
+    }
+    sampled_ = false;
+    rocksdb::SetPerfLevel(level_);
+    auto perf_context = rocksdb::get_perf_context();
+    for (auto &stage : perf_stages_) {
+        stage.second->Observe((perf_context->*stage.first) / 1000.0);
+    }
+    auto iostats_context = rocksdb::get_iostats_context();
+    for (auto &stage : iostats_stages_) {
+        stage.second->Observe((iostats_context->*stage.first) / 1000.0);
+    }
+}
@@ -0,0 +1,48 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "rocksdb/perf_context.h"
+#include "rocksdb/perf_level.h"
+#include "rocksdb/iostats_context.h"
+#include "prometheus/histogram.h"
+
+enum PerfStages {
+    PERF_WRITE, PERF_GET, PERF_SEEK, PERF_TXN
+};
+
+/*
+ * Times 1 in sample_every ops of one benchmark thread with the perf context: the perf level is
+ * enabled for the sampled op only, then every stage of the op (wal write, memtable insert, write
+ * delay, block read, ...) is observed into rocksdb_perf_stage_micros{type,stage}. The timers of
+ * a sampled op cost about a microsecond, 1 in 100 keeps them below 1% of the ops.
+ *
+ *     PerfSampler sampler(family, "put", PERF_WRITE, 100);
+ *     sampler.Begin();
+ *     db->Put(...);
+ *     sampler.End();
+ */
+class PerfSampler {
+public:
+    PerfSampler(prometheus::Family<prometheus::Histogram> &family, const std::string &type,
+                PerfStages stages, uint64_t sample_every);
+
+    // true if this op is sampled, the perf and iostats contexts are reset
+    bool Begin();
+
+    // observes the stages of a sampled op and restores the perf level
+    void End();
+
+private:
+    uint64_t sample_every_;
+    uint64_t count_;
+    bool sampled_;
+    rocksdb::PerfLevel level_;
+    std::vector<std::pair<uint64_t rocksdb::PerfContext::*, prometheus::Histogram *>> perf_stages_;
+    std::vector<std::pair<uint64_t rocksdb::IOStatsContext::*, prometheus::Histogram *>> iostats_stages_;
+};
@@ -0,0 +1,123 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <chrono>
+#include "rate_limiter_metrics.hh"
+#include "prometheus/counter.h"
+#include "prometheus/gauge.h"
+#include "prometheus/histogram.h"
+
+const char *GetIoPriorityName(rocksdb::Env::IOPriority pri) {
+    switch (pri) {
+        case rocksdb::Env::IO_LOW:
+            return "low";
+        case rocksdb::Env::IO_MID:
+            return "mid";
+        case rocksdb::Env::IO_HIGH:
+            return "high";
+        case rocksdb::Env::IO_USER:
+            return "user";
+        case rocksdb::Env::IO_TOTAL:
+            return "total";
+        default:
+            return "Invalid";
+    }
+}
+
+
+RateLimiterStatistics::RateLimiterStatistics()
+        : BaseMetrics(),
+#define _rate_limiter_init_counter_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildCounter() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .Register(*registry_) \
+    ),
+        _rate_limiter_make_counter_family(_rate_limiter_init_counter_familys)
+
+#define _rate_limiter_init_gauge_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildGauge() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .Register(*registry_) \
+    ),
+        _rate_limiter_make_gauge_family(_rate_limiter_init_gauge_familys)
+
+#define _rate_limiter_init_histogram_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildHistogram() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .BucketBoundaries(prometheus::Histogram::ExponentialBuckets(1, 2.0, 24)) \
+    .Register(*registry_) \
+    ),
+        _rate_limiter_make_histogram_family(_rate_limiter_init_histogram_familys)
+
+        dummy_() {
+}
+
+
+InstrumentedRateLimiter::InstrumentedRateLimiter(const std::shared_ptr<rocksdb::RateLimiter> &target,
+                                                 rocksdb::RateLimiter::Mode mode,
+                                                 bool auto_tuned,
+                                                 RateLimiterStatistics &statistics)
+        : rocksdb::RateLimiter(mode), target_(target) {
+    for (int pri = 0; pri < rocksdb::Env::IO_TOTAL; pri++) {
+        auto name = GetIoPriorityName(rocksdb::Env::IOPriority(pri));
+        bytes_[pri] = &statistics.STORE_RATE_LIMITER_BYTES_VEC.WithLabelValues({name});
+        requests_[pri] = &statistics.STORE_RATE_LIMITER_REQUESTS_VEC.WithLabelValues({name});
+        pending_[pri] = &statistics.STORE_RATE_LIMITER_PENDING_VEC.WithLabelValues({name});
+        wait_[pri] = &statistics.STORE_RATE_LIMITER_WAIT_VEC.WithLabelValues({name});
+    }
+    bytes_per_second_ = &statistics.STORE_RATE_LIMITER_RATE_VEC.WithLabelValues({auto_tuned ? "auto_tuned" : "fixed"});
+    bytes_per_second_->Set(target_->GetBytesPerSecond());
+}
+
+void InstrumentedRateLimiter::SetBytesPerSecond(int64_t bytes_per_second) {
+    target_->SetBytesPerSecond(bytes_per_second);
+    bytes_per_second_->Set(target_->GetBytesPerSecond());
+}
+
+void InstrumentedRateLimiter::Request(const int64_t bytes, const rocksdb::Env::IOPriority pri,
+                                      rocksdb::Statistics *stats) {
+    if (pri < 0 || pri >= rocksdb::Env::IO_TOTAL) {
+        target_->Request(bytes, pri, stats);
+        return;
+    }
+    pending_[pri]->Increment();
+    auto start = std::chrono::steady_clock::now();
+    target_->Request(bytes, pri, stats);
+    auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    pending_[pri]->Decrement();
+
+    bytes_[pri]->Increment(bytes);
+    requests_[pri]->Increment();
+    wait_[pri]->Observe(wait.count());
+    // auto tuning changes the rate inside the target
+    bytes_per_second_->Set(target_->GetBytesPerSecond());
+}
+
+int64_t InstrumentedRateLimiter::GetSingleBurstBytes() const {
+    return target_->GetSingleBurstBytes();
+}
+
+int64_t InstrumentedRateLimiter::GetTotalBytesThrough(const rocksdb::Env::IOPriority pri) const {
+    return target_->GetTotalBytesThrough(pri);
+}
+
+int64_t InstrumentedRateLimiter::GetTotalRequests(const rocksdb::Env::IOPriority pri) const {
+    return target_->GetTotalRequests(pri);
+}
+
+rocksdb::Status InstrumentedRateLimiter::GetTotalPendingRequests(int64_t *total_pending_requests,
+                                                                 const rocksdb::Env::IOPriority pri) const {
+    return target_->GetTotalPendingRequests(total_pending_requests, pri);
+}
+
+int64_t InstrumentedRateLimiter::GetBytesPerSecond() const {
+    return target_->GetBytesPerSecond();
+}
@@ -0,0 +1,84 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <rocksdb/env.h>
+#include <rocksdb/rate_limiter.h>
+#include "metrics.hh"
+
+const char *GetIoPriorityName(rocksdb::Env::IOPriority pri);
+
+
+class RateLimiterStatistics : public BaseMetrics {
+public:
+    RateLimiterStatistics();
+
+#define _rate_limiter_make_counter_family(val) \
+    val(STORE_RATE_LIMITER_BYTES_VEC,       "engine_rate_limiter_bytes",        "Bytes granted by the rate limiter",             "pri") \
+    val(STORE_RATE_LIMITER_REQUESTS_VEC,    "engine_rate_limiter_requests",     "Number of requests to the rate limiter",        "pri") \
+
+
+#define _rate_limiter_make_gauge_family(val) \
+    val(STORE_RATE_LIMITER_PENDING_VEC,     "engine_rate_limiter_pending_requests", "Requests queued in the rate limiter",      "pri") \
+    val(STORE_RATE_LIMITER_RATE_VEC,        "engine_rate_limiter_bytes_per_second", "Current rate of the rate limiter",         "mode") \
+
+
+#define _rate_limiter_make_histogram_family(val) \
+    val(STORE_RATE_LIMITER_WAIT_VEC,        "engine_rate_limiter_wait_micros",  "Time a request waits in the rate limiter",      "pri") \
+
+
+private:
+    friend class InstrumentedRateLimiter;
+
+#define _rate_limiter_make_counter_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Counter>& param;
+    _rate_limiter_make_counter_family(_rate_limiter_make_counter_params)
+#define _rate_limiter_make_gauge_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Gauge>& param;
+    _rate_limiter_make_gauge_family(_rate_limiter_make_gauge_params)
+#define _rate_limiter_make_histogram_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Histogram>& param;
+    _rate_limiter_make_histogram_family(_rate_limiter_make_histogram_params)
+
+    int dummy_;
+};
+
+
+/*
+ * Forwards to a rocksdb rate limiter and records the bytes, requests, queued requests and
+ * wait time of every io priority. The mode must be the one the target was created with.
+ */
+class InstrumentedRateLimiter : public rocksdb::RateLimiter {
+public:
+    InstrumentedRateLimiter(const std::shared_ptr<rocksdb::RateLimiter> &target,
+                            rocksdb::RateLimiter::Mode mode,
+                            bool auto_tuned,
+                            RateLimiterStatistics &statistics);
+
+    void SetBytesPerSecond(int64_t bytes_per_second) override;
+
+    using rocksdb::RateLimiter::Request;
+
+    void Request(const int64_t bytes, const rocksdb::Env::IOPriority pri, rocksdb::Statistics *stats) override;
+
+    int64_t GetSingleBurstBytes() const override;
+
+    int64_t GetTotalBytesThrough(const rocksdb::Env::IOPriority pri) const override;
+
+    int64_t GetTotalRequests(const rocksdb::Env::IOPriority pri) const override;
+
+    rocksdb::Status GetTotalPendingRequests(int64_t *total_pending_requests,
+                                            const rocksdb::Env::IOPriority pri) const override;
+
+    int64_t GetBytesPerSecond() const override;
+
+private:
+    std::shared_ptr<rocksdb::RateLimiter> target_;
+    prometheus::Counter *bytes_[rocksdb::Env::IO_TOTAL];
+    prometheus::Counter *requests_[rocksdb::Env::IO_TOTAL];
+    prometheus::Gauge *pending_[rocksdb::Env::IO_TOTAL];
+    prometheus::Histogram *wait_[rocksdb::Env::IO_TOTAL];
+    prometheus::Gauge *bytes_per_second_;
+};
@@ -2,64 +2,233 @@
 // Created by zhengcf on 2019-05-25.
 //
 
+#include <cstdlib>
+#include <cstring>
 #include "rocksdb_metrics.hh"
 #include "prometheus/counter.h"
 #include "prometheus/histogram.h"
 
+// stats of the levels in the rocksdb.cfstats map ("compaction.L1.WriteGB") exported, the GB ones in bytes
+struct LevelStat {
+    const char *property;
+    const char *type;
+    double scale;
+};
+
+static const double GB = 1024.0 * 1024.0 * 1024.0;
+
+static const LevelStat LEVEL_STATS[] = {
+        {"NumFiles",     "num_files",        1},
+        {"SizeBytes",    "size_bytes",       1},
+        {"Score",        "score",            1},
+        {"ReadGB",       "read_bytes",       GB},
+        {"WriteGB",      "write_bytes",      GB},
+        {"WnewGB",       "write_new_bytes",  GB},
+        {"MovedGB",      "moved_bytes",      GB},
+        {"WriteAmp",     "write_amp",        1},
+        {"CompSec",      "comp_seconds",     1},
+        {"CompMergeCPU", "comp_cpu_seconds", 1},
+        {"CompCount",    "comp_count",       1},
+        {"KeyIn",        "key_in",           1},
+        {"KeyDrop",      "key_drop",         1},
+};
+
+
+StatisticsEventListener::CfHandles &StatisticsEventListener::GetCfHandles(const std::string &cf) {
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+    auto &handles = cf_handles_[cf];
+    if (handles) {
+        return *handles;
+    }
+    handles.reset(new CfHandles());
+    auto &events = statistics_.STORE_ENGINE_EVENT_COUNTER_VEC;
+    handles->flush = &events.WithLabelValues({db_name_, cf, "flush"});
+    handles->compaction = &events.WithLabelValues({db_name_, cf, "compaction"});
+    handles->ingestion = &events.WithLabelValues({db_name_, cf, "ingestion"});
+    handles->stall_conditions_changed = &events.WithLabelValues({db_name_, cf, "stall_conditions_changed"});
+    handles->compaction_duration = &statistics_.STORE_ENGINE_COMPACTION_DURATIONS_VEC.WithLabelValues({db_name_, cf});
+    handles->num_corrupt_keys = &statistics_.STORE_ENGINE_COMPACTION_NUM_CORRUPT_KEYS_VEC.WithLabelValues({db_name_, cf});
+    auto &dropped = statistics_.STORE_ENGINE_COMPACTION_DROPPED_VEC;
+    handles->dropped_keys = &dropped.WithLabelValues({db_name_, cf, "dropped_keys"});
+    handles->dropped_bytes = &dropped.WithLabelValues({db_name_, cf, "dropped_bytes"});
+    handles->replaced_keys = &dropped.WithLabelValues({db_name_, cf, "replaced_keys"});
+    auto &stall_conditions = statistics_.STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC;
+    handles->triggered_writes_slowdown = &stall_conditions.WithLabelValues({db_name_, cf, "triggered_writes_slowdown"});
+    handles->triggered_writes_stop = &stall_conditions.WithLabelValues({db_name_, cf, "triggered_writes_stop"});
+    return *handles;
+}
+
+prometheus::Counter &StatisticsEventListener::GetCompactionReasonCounter(const std::string &cf, CfHandles &handles,
+                                                                         rocksdb::CompactionReason reason) {
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+    auto &counter = handles.compaction_reasons[reason];
+    if (counter == nullptr) {
+        counter = &statistics_.STORE_ENGINE_COMPACTION_REASON_VEC
+                .WithLabelValues({db_name_, cf, GetCompactionReasonString(reason)});
+    }
+    return *counter;
+}
+
+prometheus::Gauge &StatisticsEventListener::GetStallConditionGauge(const std::string &cf, CfHandles &handles,
+                                                                   rocksdb::WriteStallCondition condition) {
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+    auto &gauge = handles.stall_conditions[condition];
+    if (gauge == nullptr) {
+        gauge = &statistics_.STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC
+                .WithLabelValues({db_name_, cf, GetWriteStallConditionString(condition)});
+    }
+    return *gauge;
+}
+
+StatisticsEventListener::LevelHandles &StatisticsEventListener::GetLevelHandles(const std::string &cf,
+                                                                                CfHandles &handles, int level) {
+    std::lock_guard<std::mutex> lock(handles_mutex_);
+    auto it = handles.levels.find(level);
+    if (it != handles.levels.end()) {
+        return it->second;
+    }
+    auto str_level = std::to_string(level);
+    auto &compaction_level = statistics_.STORE_ENGINE_COMPACTION_LEVEL_VEC;
+    auto &compression_bytes = statistics_.STORE_ENGINE_COMPRESSION_BYTES_VEC;
+    LevelHandles level_handles;
+    level_handles.cpu_micros = &compaction_level.WithLabelValues({db_name_, cf, str_level, "cpu_micros"});
+    level_handles.output_bytes = &compaction_level.WithLabelValues({db_name_, cf, str_level, "output_bytes"});
+    level_handles.raw_bytes = &compression_bytes.WithLabelValues({db_name_, cf, str_level, "raw"});
+    level_handles.compressed_bytes = &compression_bytes.WithLabelValues({db_name_, cf, str_level, "compressed"});
+    level_handles.saved_bytes = &compression_bytes.WithLabelValues({db_name_, cf, str_level, "saved"});
+    return handles.levels.insert(std::make_pair(level, level_handles)).first->second;
+}
+
+TraceEvent StatisticsEventListener::NewTraceEvent(char phase, const std::string &name, const std::string &cf) {
+    TraceEvent event;
+    memset(&event, 0, sizeof(event));
+    event.phase = phase;
+    TraceRecorder::CopyName(event.name, sizeof(event.name), name);
+    TraceRecorder::CopyName(event.cf, sizeof(event.cf), cf);
+    event.pid = trace_pid_;
+    event.micros = trace_recorder_->NowMicros();
+    return event;
+}
+
+void StatisticsEventListener::OnFlushBegin(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) {
+    if (trace_recorder_ == nullptr) {
+        return;
+    }
+    auto event = NewTraceEvent('B', "flush " + info.cf_name, info.cf_name);
+    TraceRecorder::CopyName(event.reason, sizeof(event.reason), GetFlushReasonString(info.flush_reason));
+    event.tid = info.thread_id;
+    event.job_id = info.job_id;
+    event.input_level = -1;
+    event.output_level = 0;
+    trace_recorder_->Record(event);
+}
 
 void StatisticsEventListener::OnFlushCompleted(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) {
-    statistics_.STORE_ENGINE_EVENT_COUNTER_VEC
-            .WithLabelValues({db_name_, info.cf_name, "flush"})
-            .Increment();
-    statistics_.STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC
-            .WithLabelValues({db_name_, info.cf_name, "triggered_writes_slowdown"})
-            .Set(int64_t(info.triggered_writes_slowdown));
-    statistics_.STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC
-            .WithLabelValues({db_name_, info.cf_name, "triggered_writes_stop"})
-            .Set(int64_t(info.triggered_writes_stop));
+    auto &handles = GetCfHandles(info.cf_name);
+    handles.flush->Increment();
+    handles.triggered_writes_slowdown->Set(int64_t(info.triggered_writes_slowdown));
+    handles.triggered_writes_stop->Set(int64_t(info.triggered_writes_stop));
+    RecordCompressionBytes(GetLevelHandles(info.cf_name, handles, 0), info.table_properties);
+
+    if (trace_recorder_ != nullptr) {
+        auto event = NewTraceEvent('E', "flush " + info.cf_name, info.cf_name);
+        const auto &props = info.table_properties;
+        event.tid = info.thread_id;
+        event.job_id = info.job_id;
+        event.output_files = 1;
+        event.input_bytes = props.raw_key_size + props.raw_value_size;
+        event.output_bytes = props.data_size + props.index_size + props.filter_size;
+        trace_recorder_->Record(event);
+    }
+}
+
+void StatisticsEventListener::OnCompactionBegin(rocksdb::DB *db, const rocksdb::CompactionJobInfo &info) {
+    if (trace_recorder_ == nullptr) {
+        return;
+    }
+    auto name = "compaction L" + std::to_string(info.base_input_level) + "->L" + std::to_string(info.output_level);
+    auto event = NewTraceEvent('B', name, info.cf_name);
+    TraceRecorder::CopyName(event.reason, sizeof(event.reason), GetCompactionReasonString(info.compaction_reason));
+    event.tid = info.thread_id;
+    event.job_id = info.job_id;
+    event.input_level = info.base_input_level;
+    event.output_level = info.output_level;
+    event.input_files = info.input_files.size();
+    trace_recorder_->Record(event);
 }
 
 void StatisticsEventListener::OnCompactionCompleted(rocksdb::DB *db,
                                                     const rocksdb::CompactionJobInfo &info) {
-    statistics_.STORE_ENGINE_EVENT_COUNTER_VEC
-            .WithLabelValues({db_name_, info.cf_name, "compaction"})
-            .Increment();
-    statistics_.STORE_ENGINE_COMPACTION_DURATIONS_VEC
-            .WithLabelValues({db_name_, info.cf_name})
-            .Observe(double(info.stats.elapsed_micros) / 1000000.0);
-    statistics_.STORE_ENGINE_COMPACTION_NUM_CORRUPT_KEYS_VEC
-            .WithLabelValues({db_name_, info.cf_name})
-            .Increment(info.stats.num_corrupt_keys);
-    statistics_.STORE_ENGINE_COMPACTION_REASON_VEC
-            .WithLabelValues({db_name_,
-                              info.cf_name,
-                              GetCompactionReasonString(info.compaction_reason)})
-            .Increment();
+    if (trace_recorder_ != nullptr) {
+        auto name = "compaction L" + std::to_string(info.base_input_level) + "->L" + std::to_string(info.output_level);
+        auto event = NewTraceEvent('E', name, info.cf_name);
+        event.tid = info.thread_id;
+        event.job_id = info.job_id;
+        event.input_level = info.base_input_level;
+        event.output_level = info.output_level;
+        event.input_files = info.stats.num_input_files;
+        event.output_files = info.stats.num_output_files;
+        event.input_bytes = info.stats.total_input_bytes;
+        event.output_bytes = info.stats.total_output_bytes;
+        trace_recorder_->Record(event);
+    }
+
+    auto &handles = GetCfHandles(info.cf_name);
+    handles.compaction->Increment();
+    handles.compaction_duration->Observe(double(info.stats.elapsed_micros) / 1000000.0);
+    handles.num_corrupt_keys->Increment(info.stats.num_corrupt_keys);
+    GetCompactionReasonCounter(info.cf_name, handles, info.compaction_reason).Increment();
+
+    // Records neither written out nor replaced by a newer version were dropped for any reason
+    // (ttl expired, deleted, range deleted...), an upper bound of the ttl drops; their bytes are
+    // estimated by the average input record size.
+    const auto &stats = info.stats;
+    if (stats.num_input_records > stats.num_output_records + stats.num_records_replaced) {
+        uint64_t dropped = stats.num_input_records - stats.num_output_records - stats.num_records_replaced;
+        double avg_record_bytes = double(stats.total_input_raw_key_bytes + stats.total_input_raw_value_bytes)
+                                  / stats.num_input_records;
+        handles.dropped_keys->Increment(dropped);
+        handles.dropped_bytes->Increment(dropped * avg_record_bytes);
+    }
+    handles.replaced_keys->Increment(stats.num_records_replaced);
+
+    // What the compression of the output level costs (cpu) and buys (saved bytes)
+    auto &level_handles = GetLevelHandles(info.cf_name, handles, info.output_level);
+    level_handles.cpu_micros->Increment(stats.cpu_micros);
+    level_handles.output_bytes->Increment(stats.total_output_bytes);
+    for (auto &file : info.output_files) {
+        auto it = info.table_properties.find(file);
+        if (it != info.table_properties.end() && it->second) {
+            RecordCompressionBytes(level_handles, *it->second);
+        }
+    }
+}
+
+void StatisticsEventListener::RecordCompressionBytes(LevelHandles &level_handles,
+                                                     const rocksdb::TableProperties &props) {
+    uint64_t raw = props.raw_key_size + props.raw_value_size;
+    level_handles.raw_bytes->Increment(raw);
+    level_handles.compressed_bytes->Increment(props.data_size);
+    level_handles.saved_bytes->Increment(raw > props.data_size ? raw - props.data_size : 0);
 }
 
 void StatisticsEventListener::OnExternalFileIngested(rocksdb::DB *db,
                                                      const rocksdb::ExternalFileIngestionInfo &info) {
-    statistics_.STORE_ENGINE_EVENT_COUNTER_VEC
-            .WithLabelValues({db_name_, info.cf_name, "ingestion"})
-            .Increment();
+    GetCfHandles(info.cf_name).ingestion->Increment();
 }
 
 void StatisticsEventListener::OnStallConditionsChanged(const rocksdb::WriteStallInfo &info) {
-    statistics_.STORE_ENGINE_EVENT_COUNTER_VEC
-            .WithLabelValues({db_name_, info.cf_name, "stall_conditions_changed"})
-            .Increment();
-
-    statistics_.STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC
-            .WithLabelValues({db_name_,
-                              info.cf_name,
-                              GetWriteStallConditionString(info.condition.cur),
-                             })
-            .Set(1);
-    statistics_.STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC
-            .WithLabelValues({db_name_,
-                              info.cf_name,
-                              GetWriteStallConditionString(info.condition.prev)})
-            .Set(0);
+    auto &handles = GetCfHandles(info.cf_name);
+    handles.stall_conditions_changed->Increment();
+    GetStallConditionGauge(info.cf_name, handles, info.condition.cur).Set(1);
+    GetStallConditionGauge(info.cf_name, handles, info.condition.prev).Set(0);
+
+    if (trace_recorder_ != nullptr) {
+        auto event = NewTraceEvent('C', "stall " + info.cf_name, info.cf_name);
+        event.value = info.condition.cur == rocksdb::WriteStallCondition::kStopped ? 2
+                      : info.condition.cur == rocksdb::WriteStallCondition::kDelayed ? 1 : 0;
+        trace_recorder_->Record(event);
+    }
 }
 
 const char *StatisticsEventListener::GetCompactionReasonString(rocksdb::CompactionReason compaction_reason) {
@@ -95,6 +264,10 @@ const char *StatisticsEventListener::GetCompactionReasonString(rocksdb::Compacti
             return "Flush";
         case CompactionReason::kExternalSstIngestion:
             return "ExternalSstIngestion";
+        case CompactionReason::kPeriodicCompaction:
+            return "PeriodicCompaction";
+        case CompactionReason::kForcedBlobGC:
+            return "ForcedBlobGC";
         case CompactionReason::kNumOfReasons:
             // fall through
         default:
@@ -116,9 +289,39 @@ const char *StatisticsEventListener::GetWriteStallConditionString(rocksdb::Write
     }
 }
 
+const char *StatisticsEventListener::GetFlushReasonString(rocksdb::FlushReason flush_reason) {
+    using namespace rocksdb;
+    switch (flush_reason) {
+        case FlushReason::kOthers:
+            return "Others";
+        case FlushReason::kGetLiveFiles:
+            return "GetLiveFiles";
+        case FlushReason::kShutDown:
+            return "ShutDown";
+        case FlushReason::kExternalFileIngestion:
+            return "ExternalFileIngestion";
+        case FlushReason::kManualCompaction:
+            return "ManualCompaction";
+        case FlushReason::kWriteBufferManager:
+            return "WriteBufferManager";
+        case FlushReason::kWriteBufferFull:
+            return "WriteBufferFull";
+        case FlushReason::kDeleteFiles:
+            return "DeleteFiles";
+        case FlushReason::kAutoCompaction:
+            return "AutoCompaction";
+        case FlushReason::kManualFlush:
+            return "ManualFlush";
+        case FlushReason::kErrorRecovery:
+            return "ErrorRecovery";
+        default:
+            return "Invalid";
+    }
+}
 
 RocksdbStatistics::RocksdbStatistics()
         : BaseMetrics(),
+          full_filter_(true),
 #define _init_counter_familys(param, name, help, label, ...)   \
     param(prometheus::BuildCounter() \
     .Name(name) \
@@ -157,840 +360,244 @@ RocksdbStatistics::RocksdbStatistics()
 
         tickers_names_.insert(pair);
     }
-    for (
-        auto pair : rocksdb::HistogramsNameMap
-            ) {
-        std::for_each(pair.second.begin(), pair.second.end(),
-                      [](std::string::value_type &c) {
-                          c = c == '.' ? c : '-';
-                      });
-        histograms_names_.insert(pair);
-    }
+
+    ticker_metrics_ = {
+            {rocksdb::Tickers::BLOCK_CACHE_MISS,                       &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_miss"},
+            {rocksdb::Tickers::BLOCK_CACHE_HIT,                        &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_hit"},
+            {rocksdb::Tickers::BLOCK_CACHE_ADD,                        &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_add"},
+            {rocksdb::Tickers::BLOCK_CACHE_ADD_FAILURES,               &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_add_failures"},
+            {rocksdb::Tickers::BLOCK_CACHE_INDEX_MISS,                 &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_index_miss"},
+            {rocksdb::Tickers::BLOCK_CACHE_INDEX_HIT,                  &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_index_hit"},
+            {rocksdb::Tickers::BLOCK_CACHE_INDEX_ADD,                  &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_index_add"},
+            {rocksdb::Tickers::BLOCK_CACHE_INDEX_BYTES_INSERT,         &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_index_bytes_insert"},
+            {rocksdb::Tickers::BLOCK_CACHE_INDEX_BYTES_EVICT,          &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_index_bytes_evict"},
+            {rocksdb::Tickers::BLOCK_CACHE_FILTER_MISS,                &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_filter_miss"},
+            {rocksdb::Tickers::BLOCK_CACHE_FILTER_HIT,                 &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_filter_hit"},
+            {rocksdb::Tickers::BLOCK_CACHE_FILTER_ADD,                 &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_filter_add"},
+            {rocksdb::Tickers::BLOCK_CACHE_FILTER_BYTES_INSERT,        &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_filter_bytes_insert"},
+            {rocksdb::Tickers::BLOCK_CACHE_FILTER_BYTES_EVICT,         &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_filter_bytes_evict"},
+            {rocksdb::Tickers::BLOCK_CACHE_DATA_MISS,                  &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_data_miss"},
+            {rocksdb::Tickers::BLOCK_CACHE_DATA_HIT,                   &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_data_hit"},
+            {rocksdb::Tickers::BLOCK_CACHE_DATA_ADD,                   &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_data_add"},
+            {rocksdb::Tickers::BLOCK_CACHE_DATA_BYTES_INSERT,          &STORE_ENGINE_CACHE_EFFICIENCY_VEC,    "block_cache_data_bytes_insert"},
+            {rocksdb::Tickers::BLOCK_CACHE_BYTES_READ,                 &STORE_ENGINE_FLOW_VEC,                "block_cache_bytes_read"},
+            {rocksdb::Tickers::BLOCK_CACHE_BYTES_WRITE,                &STORE_ENGINE_FLOW_VEC,                "block_cache_bytes_write"},
+            {rocksdb::Tickers::BLOOM_FILTER_USEFUL,                    &STORE_ENGINE_BLOOM_EFFICIENCY_VEC,    "bloom_filter_useful"},
+            {rocksdb::Tickers::BLOOM_FILTER_FULL_POSITIVE,             &STORE_ENGINE_BLOOM_EFFICIENCY_VEC,    "bloom_filter_full_positive"},
+            {rocksdb::Tickers::BLOOM_FILTER_FULL_TRUE_POSITIVE,        &STORE_ENGINE_BLOOM_EFFICIENCY_VEC,    "bloom_filter_full_true_positive"},
+            {rocksdb::Tickers::MEMTABLE_HIT,                           &STORE_ENGINE_MEMTABLE_EFFICIENCY_VEC, "memtable_hit"},
+            {rocksdb::Tickers::MEMTABLE_MISS,                          &STORE_ENGINE_MEMTABLE_EFFICIENCY_VEC, "memtable_miss"},
+            {rocksdb::Tickers::GET_HIT_L0,                             &STORE_ENGINE_GET_SERVED_VEC,          "get_hit_l0"},
+            {rocksdb::Tickers::GET_HIT_L1,                             &STORE_ENGINE_GET_SERVED_VEC,          "get_hit_l1"},
+            {rocksdb::Tickers::GET_HIT_L2_AND_UP,                      &STORE_ENGINE_GET_SERVED_VEC,          "get_hit_l2_and_up"},
+            {rocksdb::Tickers::COMPACTION_KEY_DROP_NEWER_ENTRY,        &STORE_ENGINE_COMPACTION_DROP_VEC,     "compaction_key_drop_newer_entry"},
+            {rocksdb::Tickers::COMPACTION_KEY_DROP_OBSOLETE,           &STORE_ENGINE_COMPACTION_DROP_VEC,     "compaction_key_drop_obsolete"},
+            {rocksdb::Tickers::COMPACTION_KEY_DROP_RANGE_DEL,          &STORE_ENGINE_COMPACTION_DROP_VEC,     "compaction_key_drop_range_del"},
+            {rocksdb::Tickers::COMPACTION_RANGE_DEL_DROP_OBSOLETE,     &STORE_ENGINE_COMPACTION_DROP_VEC,     "compaction_range_del_drop_obsolete"},
+            {rocksdb::Tickers::COMPACTION_OPTIMIZED_DEL_DROP_OBSOLETE, &STORE_ENGINE_COMPACTION_DROP_VEC,     "compaction_optimized_del_drop_obsolete"},
+            {rocksdb::Tickers::COMPACTION_KEY_DROP_USER,               &STORE_ENGINE_COMPACTION_DROP_VEC,     "compaction_key_drop_user"},
+            {rocksdb::Tickers::NUMBER_KEYS_WRITTEN,                    &STORE_ENGINE_FLOW_VEC,                "number_keys_written"},
+            {rocksdb::Tickers::NUMBER_KEYS_READ,                       &STORE_ENGINE_FLOW_VEC,                "number_keys_read"},
+            {rocksdb::Tickers::NUMBER_KEYS_UPDATED,                    &STORE_ENGINE_FLOW_VEC,                "number_keys_updated"},
+            {rocksdb::Tickers::BYTES_WRITTEN,                          &STORE_ENGINE_FLOW_VEC,                "bytes_written"},
+            {rocksdb::Tickers::BYTES_READ,                             &STORE_ENGINE_FLOW_VEC,                "bytes_read"},
+            {rocksdb::Tickers::NUMBER_DB_SEEK,                         &STORE_ENGINE_LOCATE_VEC,              "number_db_seek"},
+            {rocksdb::Tickers::NUMBER_DB_NEXT,                         &STORE_ENGINE_LOCATE_VEC,              "number_db_next"},
+            {rocksdb::Tickers::NUMBER_DB_PREV,                         &STORE_ENGINE_LOCATE_VEC,              "number_db_prev"},
+            {rocksdb::Tickers::NUMBER_DB_SEEK_FOUND,                   &STORE_ENGINE_LOCATE_VEC,              "number_db_seek_found"},
+            {rocksdb::Tickers::NUMBER_DB_NEXT_FOUND,                   &STORE_ENGINE_LOCATE_VEC,              "number_db_next_found"},
+            {rocksdb::Tickers::NUMBER_DB_PREV_FOUND,                   &STORE_ENGINE_LOCATE_VEC,              "number_db_prev_found"},
+            {rocksdb::Tickers::ITER_BYTES_READ,                        &STORE_ENGINE_FLOW_VEC,                "iter_bytes_read"},
+            {rocksdb::Tickers::NO_FILE_CLOSES,                         &STORE_ENGINE_FILE_STATUS_VEC,         "no_file_closes"},
+            {rocksdb::Tickers::NO_FILE_OPENS,                          &STORE_ENGINE_FILE_STATUS_VEC,         "no_file_opens"},
+            {rocksdb::Tickers::NO_FILE_ERRORS,                         &STORE_ENGINE_FILE_STATUS_VEC,         "no_file_errors"},
+            {rocksdb::Tickers::STALL_MICROS,                           &STORE_ENGINE_STALL_MICROS,            nullptr},
+            {rocksdb::Tickers::BLOOM_FILTER_PREFIX_CHECKED,            &STORE_ENGINE_BLOOM_EFFICIENCY_VEC,    "bloom_filter_prefix_checked"},
+            {rocksdb::Tickers::BLOOM_FILTER_PREFIX_USEFUL,             &STORE_ENGINE_BLOOM_EFFICIENCY_VEC,    "bloom_filter_prefix_useful"},
+            {rocksdb::Tickers::WAL_FILE_SYNCED,                        &STORE_ENGINE_WAL_FILE_SYNCED,         nullptr},
+            {rocksdb::Tickers::WAL_FILE_BYTES,                         &STORE_ENGINE_FLOW_VEC,                "wal_file_bytes"},
+            {rocksdb::Tickers::WRITE_DONE_BY_SELF,                     &STORE_ENGINE_WRITE_SERVED_VEC,        "write_done_by_self"},
+            {rocksdb::Tickers::WRITE_DONE_BY_OTHER,                    &STORE_ENGINE_WRITE_SERVED_VEC,        "write_done_by_other"},
+            {rocksdb::Tickers::WRITE_TIMEDOUT,                         &STORE_ENGINE_WRITE_SERVED_VEC,        "write_timeout"},
+            {rocksdb::Tickers::WRITE_WITH_WAL,                         &STORE_ENGINE_WRITE_SERVED_VEC,        "write_with_wal"},
+            {rocksdb::Tickers::COMPACT_READ_BYTES,                     &STORE_ENGINE_COMPACTION_FLOW_VEC,     "compact_bytes_read"},
+            {rocksdb::Tickers::COMPACT_WRITE_BYTES,                    &STORE_ENGINE_COMPACTION_FLOW_VEC,     "compact_bytes_written"},
+            {rocksdb::Tickers::FLUSH_WRITE_BYTES,                      &STORE_ENGINE_FLOW_VEC,                "flush_write_bytes"},
+            {rocksdb::Tickers::MERGE_OPERATION_TOTAL_TIME,             &STORE_ENGINE_MERGE_TOTAL_TIME,        "merge_operation_total_time"},
+            {rocksdb::Tickers::READ_AMP_ESTIMATE_USEFUL_BYTES,         &STORE_ENGINE_READ_AMP_FLOW_VEC,       "read_amp_estimate_useful_bytes"},
+            {rocksdb::Tickers::READ_AMP_TOTAL_READ_BYTES,              &STORE_ENGINE_READ_AMP_FLOW_VEC,       "read_amp_total_read_bytes"},
+            {rocksdb::Tickers::BLOB_DB_BLOB_FILE_BYTES_WRITTEN,        &STORE_ENGINE_BLOB_FLOW_VEC,           "blob_file_bytes_written"},
+            {rocksdb::Tickers::BLOB_DB_BLOB_FILE_BYTES_READ,           &STORE_ENGINE_BLOB_FLOW_VEC,           "blob_file_bytes_read"},
+            {rocksdb::Tickers::BLOB_DB_GC_NUM_KEYS_RELOCATED,          &STORE_ENGINE_BLOB_GC_VEC,             "gc_num_keys_relocated"},
+            {rocksdb::Tickers::BLOB_DB_GC_BYTES_RELOCATED,             &STORE_ENGINE_BLOB_GC_VEC,             "gc_bytes_relocated"},
+    };
+    histogram_metrics_ = {
+            {rocksdb::Histograms::DB_GET,                          &STORE_ENGINE_GET_MICROS_VEC,                      "get"},
+            {rocksdb::Histograms::DB_WRITE,                        &STORE_ENGINE_WRITE_MICROS_VEC,                    "write"},
+            {rocksdb::Histograms::COMPACTION_TIME,                 &STORE_ENGINE_COMPACTION_TIME_VEC,                 "compaction_time"},
+            {rocksdb::Histograms::TABLE_SYNC_MICROS,               &STORE_ENGINE_TABLE_SYNC_MICROS_VEC,               "table_sync"},
+            {rocksdb::Histograms::COMPACTION_OUTFILE_SYNC_MICROS,  &STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC,  "compaction_outfile_sync"},
+            {rocksdb::Histograms::WAL_FILE_SYNC_MICROS,            &STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC,            "wal_file_sync"},
+            {rocksdb::Histograms::MANIFEST_FILE_SYNC_MICROS,       &STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC,       "manifest_file_sync"},
+            {rocksdb::Histograms::STALL_L0_SLOWDOWN_COUNT,         &STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC,         "stall_l0_slowdown_count"},
+            {rocksdb::Histograms::STALL_MEMTABLE_COMPACTION_COUNT, &STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC, "stall_memtable_compaction_count"},
+            {rocksdb::Histograms::STALL_L0_NUM_FILES_COUNT,        &STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC,        "stall_l0_num_files_count"},
+            {rocksdb::Histograms::HARD_RATE_LIMIT_DELAY_COUNT,     &STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC,     "hard_rate_limit_delay"},
+            {rocksdb::Histograms::SOFT_RATE_LIMIT_DELAY_COUNT,     &STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC,     "soft_rate_limit_delay"},
+            {rocksdb::Histograms::NUM_FILES_IN_SINGLE_COMPACTION,  &STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC,  "num_files_in_single_compaction"},
+            {rocksdb::Histograms::DB_SEEK,                         &STORE_ENGINE_SEEK_MICROS_VEC,                     "seek"},
+            {rocksdb::Histograms::WRITE_STALL,                     &STORE_ENGINE_WRITE_STALL_VEC,                     "write_stall"},
+            {rocksdb::Histograms::SST_READ_MICROS,                 &STORE_ENGINE_SST_READ_MICROS_VEC,                 "sst_read_micros"},
+            {rocksdb::Histograms::NUM_SUBCOMPACTIONS_SCHEDULED,    &STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC,     "num_subcompaction_scheduled"},
+            {rocksdb::Histograms::BYTES_PER_READ,                  &STORE_ENGINE_BYTES_PER_READ_VEC,                  "bytes_per_read"},
+            {rocksdb::Histograms::BYTES_PER_WRITE,                 &STORE_ENGINE_BYTES_PER_WRITE_VEC,                 "bytes_per_write"},
+            {rocksdb::Histograms::BYTES_COMPRESSED,                &STORE_ENGINE_BYTES_COMPRESSED_VEC,                "bytes_compressed"},
+            {rocksdb::Histograms::BYTES_DECOMPRESSED,              &STORE_ENGINE_BYTES_DECOMPRESSED_VEC,              "bytes_decompressed"},
+            {rocksdb::Histograms::COMPRESSION_TIMES_NANOS,         &STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC,         "compression_time_nanos"},
+            {rocksdb::Histograms::DECOMPRESSION_TIMES_NANOS,       &STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC,       "decompression_time_nanos"},
+            {rocksdb::Histograms::READ_NUM_MERGE_OPERANDS,         &STORE_ENGINE_READ_MERGE_OPERANDS,                 "read_num_merge_operands"},
+            {rocksdb::Histograms::BLOB_DB_BLOB_FILE_READ_MICROS,   &STORE_ENGINE_BLOB_FILE_READ_MICROS_VEC,           "blob_file_read_micros"},
+            {rocksdb::Histograms::BLOB_DB_BLOB_FILE_WRITE_MICROS,  &STORE_ENGINE_BLOB_FILE_WRITE_MICROS_VEC,          "blob_file_write_micros"},
+    };
 }
 
 
 void RocksdbStatistics::FlushMetrics(rocksdb::DB &db, const std::string &name,
                                      const std::vector<rocksdb::ColumnFamilyHandle *> &db_cfs) {
     auto statistics = db.GetDBOptions().statistics;
-    for (auto &pair: this->tickers_names_) {
-        auto v = statistics->getAndResetTickerCount(pair.first);
-        FlushEngineTickerMetrics(pair.first, v, name);
+    auto &handles = GetDbMetricHandles(name);
+    uint64_t filter_useful = 0, filter_positive = 0, filter_true_positive = 0;
+    // Deltas of the cumulative tickers, the statistics are never reset
+    auto &last_tickers = handles.last_tickers[&db];
+    last_tickers.resize(handles.tickers.size(), 0);
+    for (size_t i = 0; i < handles.tickers.size(); i++) {
+        auto &ticker = handles.tickers[i];
+        auto count = statistics->getTickerCount(ticker.first);
+        auto v = count >= last_tickers[i] ? count - last_tickers[i] : count;
+        last_tickers[i] = count;
+        if (int64_t(v) < 0) {
+            std::cout << "ticker is overflow, ticker: " << tickers_names_[ticker.first] << ";value" << v << std::endl;
+        }
+        ticker.second->Increment(int64_t(v));
+        if (ticker.first == rocksdb::Tickers::BLOOM_FILTER_USEFUL) {
+            filter_useful = v;
+        } else if (ticker.first == rocksdb::Tickers::BLOOM_FILTER_FULL_POSITIVE) {
+            filter_positive = v;
+        } else if (ticker.first == rocksdb::Tickers::BLOOM_FILTER_FULL_TRUE_POSITIVE) {
+            filter_true_positive = v;
+        }
     }
 
-    for (auto &pair: this->histograms_names_) {
+    // Of the filter probes for keys not in the sst (filtered out + passed but not found),
+    // the part passed by the filter, over this interval
+    uint64_t filter_negatives = filter_useful + filter_positive - filter_true_positive;
+    if (handles.filter_false_positive_rate && filter_positive >= filter_true_positive && filter_negatives > 0) {
+        handles.filter_false_positive_rate->Set(double(filter_positive - filter_true_positive) / filter_negatives);
+    }
+
+    for (auto &gauges : handles.histograms) {
         rocksdb::HistogramData hisdata;
-        statistics->histogramData(pair.first, &hisdata);
-        FlushEngineHistogramMetrics(pair.first, hisdata, name);
+        statistics->histogramData(gauges.histogram, &hisdata);
+        gauges.median->Set(hisdata.median);
+        gauges.percentile95->Set(hisdata.percentile95);
+        gauges.percentile99->Set(hisdata.percentile99);
+        gauges.average->Set(hisdata.average);
+        gauges.standard_deviation->Set(hisdata.standard_deviation);
+        gauges.max->Set(hisdata.max);
+    }
+
+    // the sums are only recorded with stats level kExceptTimeForMutex and above
+    rocksdb::HistogramData compressed, compress_nanos, decompressed, decompress_nanos;
+    statistics->histogramData(rocksdb::Histograms::BYTES_COMPRESSED, &compressed);
+    statistics->histogramData(rocksdb::Histograms::COMPRESSION_TIMES_NANOS, &compress_nanos);
+    statistics->histogramData(rocksdb::Histograms::BYTES_DECOMPRESSED, &decompressed);
+    statistics->histogramData(rocksdb::Histograms::DECOMPRESSION_TIMES_NANOS, &decompress_nanos);
+    if (compressed.sum > 0) {
+        handles.compress_cost->Set(double(compress_nanos.sum) / compressed.sum);
+    }
+    if (decompressed.sum > 0) {
+        handles.decompress_cost->Set(double(decompress_nanos.sum) / decompressed.sum);
     }
 
     FlushEngineProperties(db, name, db_cfs);
 }
 
 
-void RocksdbStatistics::FlushEngineTickerMetrics(rocksdb::Tickers t, const uint64_t value, const std::string &name) {
-    int64_t v = value;
-    if (v < 0) {
-        std::cout << "ticker is overflow, ticker: " << tickers_names_[t] << ";value" << value << std::endl;
+void RocksdbStatistics::FlushMemoryBudget(rocksdb::Cache *cache, rocksdb::WriteBufferManager *write_buffer_manager) {
+    if (cache != nullptr) {
+        STORE_ENGINE_MEMORY_BUDGET_VEC.WithLabelValues({"block_cache_capacity"}).Set(cache->GetCapacity());
+        STORE_ENGINE_MEMORY_BUDGET_VEC.WithLabelValues({"block_cache_usage"}).Set(cache->GetUsage());
+        STORE_ENGINE_MEMORY_BUDGET_VEC.WithLabelValues({"block_cache_pinned_usage"}).Set(cache->GetPinnedUsage());
+    }
+    if (write_buffer_manager != nullptr) {
+        STORE_ENGINE_MEMORY_BUDGET_VEC
+                .WithLabelValues({"write_buffer_limit"})
+                .Set(write_buffer_manager->buffer_size());
+        STORE_ENGINE_MEMORY_BUDGET_VEC
+                .WithLabelValues({"write_buffer_usage"})
+                .Set(write_buffer_manager->memory_usage());
+        STORE_ENGINE_MEMORY_BUDGET_VEC
+                .WithLabelValues({"write_buffer_mutable_usage"})
+                .Set(write_buffer_manager->mutable_memtable_memory_usage());
     }
+}
 
-    switch (t) {
-        case rocksdb::Tickers::BLOCK_CACHE_MISS :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_miss"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_HIT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_hit"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_ADD :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_add"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_ADD_FAILURES :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_add_failures"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_INDEX_MISS :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_index_miss"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_INDEX_HIT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_index_hit"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_INDEX_ADD :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_index_add"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_INDEX_BYTES_INSERT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_index_bytes_insert"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_INDEX_BYTES_EVICT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_index_bytes_evict"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_FILTER_MISS :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_filter_miss"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_FILTER_HIT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_filter_hit"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_FILTER_ADD :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_filter_add"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_FILTER_BYTES_INSERT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_filter_bytes_insert"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_FILTER_BYTES_EVICT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_filter_bytes_evict"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_DATA_MISS :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_data_miss"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_DATA_HIT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_data_hit"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_DATA_ADD :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_data_add"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_DATA_BYTES_INSERT :
-            STORE_ENGINE_CACHE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "block_cache_data_bytes_insert"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_BYTES_READ :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "block_cache_bytes_read"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOCK_CACHE_BYTES_WRITE :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "block_cache_bytes_write"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOOM_FILTER_USEFUL :
-            STORE_ENGINE_BLOOM_EFFICIENCY_VEC
-                    .WithLabelValues({name, "bloom_filter_useful"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::MEMTABLE_HIT :
-            STORE_ENGINE_MEMTABLE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "memtable_hit"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::MEMTABLE_MISS :
-            STORE_ENGINE_MEMTABLE_EFFICIENCY_VEC
-                    .WithLabelValues({name, "memtable_miss"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::GET_HIT_L0 :
-            STORE_ENGINE_GET_SERVED_VEC
-                    .WithLabelValues({name, "get_hit_l0"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::GET_HIT_L1 :
-            STORE_ENGINE_GET_SERVED_VEC
-                    .WithLabelValues({name, "get_hit_l1"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::GET_HIT_L2_AND_UP :
-            STORE_ENGINE_GET_SERVED_VEC
-                    .WithLabelValues({name, "get_hit_l2_and_up"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACTION_KEY_DROP_NEWER_ENTRY :
-            STORE_ENGINE_COMPACTION_DROP_VEC
-                    .WithLabelValues({name, "compaction_key_drop_newer_entry"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACTION_KEY_DROP_OBSOLETE :
-            STORE_ENGINE_COMPACTION_DROP_VEC
-                    .WithLabelValues({name, "compaction_key_drop_obsolete"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACTION_KEY_DROP_RANGE_DEL :
-            STORE_ENGINE_COMPACTION_DROP_VEC
-                    .WithLabelValues({name, "compaction_key_drop_range_del"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACTION_RANGE_DEL_DROP_OBSOLETE :
-            STORE_ENGINE_COMPACTION_DROP_VEC
-                    .WithLabelValues({name, "compaction_range_del_drop_obsolete"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACTION_OPTIMIZED_DEL_DROP_OBSOLETE :
-            STORE_ENGINE_COMPACTION_DROP_VEC
-                    .WithLabelValues({name, "compaction_optimized_del_drop_obsolete"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_KEYS_WRITTEN :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "number_keys_written"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_KEYS_READ :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "number_keys_read"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_KEYS_UPDATED :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "number_keys_updated"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BYTES_WRITTEN :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "bytes_written"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BYTES_READ :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "bytes_read"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_DB_SEEK :
-            STORE_ENGINE_LOCATE_VEC
-                    .WithLabelValues({name, "number_db_seek"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_DB_NEXT :
-            STORE_ENGINE_LOCATE_VEC
-                    .WithLabelValues({name, "number_db_next"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_DB_PREV :
-            STORE_ENGINE_LOCATE_VEC
-                    .WithLabelValues({name, "number_db_prev"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_DB_SEEK_FOUND :
-            STORE_ENGINE_LOCATE_VEC
-                    .WithLabelValues({name, "number_db_seek_found"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_DB_NEXT_FOUND :
-            STORE_ENGINE_LOCATE_VEC
-                    .WithLabelValues({name, "number_db_next_found"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NUMBER_DB_PREV_FOUND :
-            STORE_ENGINE_LOCATE_VEC
-                    .WithLabelValues({name, "number_db_prev_found"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::ITER_BYTES_READ :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "iter_bytes_read"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NO_FILE_CLOSES :
-            STORE_ENGINE_FILE_STATUS_VEC
-                    .WithLabelValues({name, "no_file_closes"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NO_FILE_OPENS :
-            STORE_ENGINE_FILE_STATUS_VEC
-                    .WithLabelValues({name, "no_file_opens"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::NO_FILE_ERRORS :
-            STORE_ENGINE_FILE_STATUS_VEC
-                    .WithLabelValues({name, "no_file_errors"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::STALL_MICROS :
-            STORE_ENGINE_STALL_MICROS
-                    .WithLabelValues({name})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOOM_FILTER_PREFIX_CHECKED :
-            STORE_ENGINE_BLOOM_EFFICIENCY_VEC
-                    .WithLabelValues({name, "bloom_filter_prefix_checked"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::BLOOM_FILTER_PREFIX_USEFUL :
-            STORE_ENGINE_BLOOM_EFFICIENCY_VEC
-                    .WithLabelValues({name, "bloom_filter_prefix_useful"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::WAL_FILE_SYNCED :
-            STORE_ENGINE_WAL_FILE_SYNCED
-                    .WithLabelValues({name})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::WAL_FILE_BYTES :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "wal_file_bytes"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::WRITE_DONE_BY_SELF :
-            STORE_ENGINE_WRITE_SERVED_VEC
-                    .WithLabelValues({name, "write_done_by_self"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::WRITE_DONE_BY_OTHER :
-            STORE_ENGINE_WRITE_SERVED_VEC
-                    .WithLabelValues({name, "write_done_by_other"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::WRITE_TIMEDOUT :
-            STORE_ENGINE_WRITE_SERVED_VEC
-                    .WithLabelValues({name, "write_timeout"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::WRITE_WITH_WAL :
-            STORE_ENGINE_WRITE_SERVED_VEC
-                    .WithLabelValues({name, "write_with_wal"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACT_READ_BYTES :
-            STORE_ENGINE_COMPACTION_FLOW_VEC
-                    .WithLabelValues({name, "compact_bytes_read"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::COMPACT_WRITE_BYTES :
-            STORE_ENGINE_COMPACTION_FLOW_VEC
-                    .WithLabelValues({name, "compact_bytes_written"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::FLUSH_WRITE_BYTES :
-            STORE_ENGINE_FLOW_VEC
-                    .WithLabelValues({name, "flush_write_bytes"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::MERGE_OPERATION_TOTAL_TIME :
-            STORE_ENGINE_MERGE_TOTAL_TIME
-                    .WithLabelValues({name, "merge_operation_total_time"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::READ_AMP_ESTIMATE_USEFUL_BYTES :
-            STORE_ENGINE_READ_AMP_FLOW_VEC
-                    .WithLabelValues({name, "read_amp_estimate_useful_bytes"})
-                    .Increment(v);
-            break;
-        case rocksdb::Tickers::READ_AMP_TOTAL_READ_BYTES :
-            STORE_ENGINE_READ_AMP_FLOW_VEC
-                    .WithLabelValues({name, "read_amp_total_read_bytes"})
-                    .Increment(v);
-            break;
-        default:
-            break;
+void RocksdbStatistics::SetFullFilter(bool full_filter) {
+    std::lock_guard<std::mutex> lock(db_handles_mutex_);
+    full_filter_ = full_filter;
+}
+
+void RocksdbStatistics::RecordOptionChanged(const std::string &name, const std::string &cf,
+                                            const std::string &option, const std::string &value) {
+    using namespace std::chrono;
+    STORE_ENGINE_OPTION_CHANGED_VEC
+            .WithLabelValues({name, cf, option})
+            .Set(duration_cast<seconds>(system_clock::now().time_since_epoch()).count());
+
+    double number;
+    if (value == "true" || value == "false") {
+        number = value == "true" ? 1 : 0;
+    } else {
+        char *end = nullptr;
+        number = strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0') {
+            return;
+        }
     }
+    STORE_ENGINE_OPTION_VALUE_VEC.WithLabelValues({name, cf, option}).Set(number);
 }
 
-void RocksdbStatistics::FlushEngineHistogramMetrics(rocksdb::Histograms t, const rocksdb::HistogramData &value,
-                                                    const std::string &name) {
-    switch (t) {
-        case rocksdb::Histograms::DB_GET :
-            STORE_ENGINE_GET_MICROS_VEC
-                    .WithLabelValues({name, "get_median"})
-                    .Set(value.median);
-            STORE_ENGINE_GET_MICROS_VEC
-                    .WithLabelValues({name, "get_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_GET_MICROS_VEC
-                    .WithLabelValues({name, "get_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_GET_MICROS_VEC
-                    .WithLabelValues({name, "get_average"})
-                    .Set(value.average);
-            STORE_ENGINE_GET_MICROS_VEC
-                    .WithLabelValues({name, "get_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_GET_MICROS_VEC
-                    .WithLabelValues({name, "get_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::DB_WRITE :
-            STORE_ENGINE_WRITE_MICROS_VEC
-                    .WithLabelValues({name, "write_median"})
-                    .Set(value.median);
-            STORE_ENGINE_WRITE_MICROS_VEC
-                    .WithLabelValues({name, "write_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_WRITE_MICROS_VEC
-                    .WithLabelValues({name, "write_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_WRITE_MICROS_VEC
-                    .WithLabelValues({name, "write_average"})
-                    .Set(value.average);
-            STORE_ENGINE_WRITE_MICROS_VEC
-                    .WithLabelValues({name, "write_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_WRITE_MICROS_VEC
-                    .WithLabelValues({name, "write_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::COMPACTION_TIME :
-            STORE_ENGINE_COMPACTION_TIME_VEC
-                    .WithLabelValues({name, "compaction_time_median"})
-                    .Set(value.median);
-            STORE_ENGINE_COMPACTION_TIME_VEC
-                    .WithLabelValues({name, "compaction_time_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_COMPACTION_TIME_VEC
-                    .WithLabelValues({name, "compaction_time_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_COMPACTION_TIME_VEC
-                    .WithLabelValues({name, "compaction_time_average"})
-                    .Set(value.average);
-            STORE_ENGINE_COMPACTION_TIME_VEC
-                    .WithLabelValues({name, "compaction_time_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_COMPACTION_TIME_VEC
-                    .WithLabelValues({name, "compaction_time_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::TABLE_SYNC_MICROS :
-            STORE_ENGINE_TABLE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "table_sync_median"})
-                    .Set(value.median);
-            STORE_ENGINE_TABLE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "table_sync_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_TABLE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "table_sync_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_TABLE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "table_sync_average"})
-                    .Set(value.average);
-            STORE_ENGINE_TABLE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "table_sync_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_TABLE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "table_sync_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::COMPACTION_OUTFILE_SYNC_MICROS :
-            STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "compaction_outfile_sync_median"})
-                    .Set(value.median);
-            STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "compaction_outfile_sync_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "compaction_outfile_sync_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "compaction_outfile_sync_average"})
-                    .Set(value.average);
-            STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "compaction_outfile_sync_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_COMPACTION_OUTFILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "compaction_outfile_sync_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::WAL_FILE_SYNC_MICROS :
-            STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "wal_file_sync_median"})
-                    .Set(value.median);
-            STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "wal_file_sync_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "wal_file_sync_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "wal_file_sync_average"})
-                    .Set(value.average);
-            STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "wal_file_sync_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_WAL_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "wal_file_sync_max"})
-                    .Set(value.standard_deviation);
-            break;
-        case rocksdb::Histograms::MANIFEST_FILE_SYNC_MICROS :
-            STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "manifest_file_sync_median"})
-                    .Set(value.median);
-            STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "manifest_file_sync_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "manifest_file_sync_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "manifest_file_sync_average"})
-                    .Set(value.average);
-            STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "manifest_file_sync_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_MANIFEST_FILE_SYNC_MICROS_VEC
-                    .WithLabelValues({name, "manifest_file_sync_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::STALL_L0_SLOWDOWN_COUNT :
-            STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_slowdown_count_median"})
-                    .Set(value.median);
-            STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_slowdown_count_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_slowdown_count_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_slowdown_count_average"})
-                    .Set(value.average);
-            STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_slowdown_count_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_STALL_L0_SLOWDOWN_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_slowdown_count_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::STALL_MEMTABLE_COMPACTION_COUNT :
-            STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC
-                    .WithLabelValues({name, "stall_memtable_compaction_count_median"})
-                    .Set(value.median);
-            STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC
-                    .WithLabelValues({name, "stall_memtable_compaction_count_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC
-                    .WithLabelValues({name, "stall_memtable_compaction_count_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC
-                    .WithLabelValues({name, "stall_memtable_compaction_count_average"})
-                    .Set(value.average);
-            STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC
-                    .WithLabelValues({name, "stall_memtable_compaction_count_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_STALL_MEMTABLE_COMPACTION_COUNT_VEC
-                    .WithLabelValues({name, "stall_memtable_compaction_count_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::STALL_L0_NUM_FILES_COUNT :
-            STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_num_files_count_median"})
-                    .Set(value.median);
-            STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_num_files_count_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_num_files_count_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_num_files_count_average"})
-                    .Set(value.average);
-            STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_num_files_count_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_STALL_LO_NUM_FILES_COUNT_VEC
-                    .WithLabelValues({name, "stall_l0_num_files_count_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::HARD_RATE_LIMIT_DELAY_COUNT :
-            STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "hard_rate_limit_delay_median"})
-                    .Set(value.median);
-            STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "hard_rate_limit_delay_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "hard_rate_limit_delay_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "hard_rate_limit_delay_average"})
-                    .Set(value.average);
-            STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "hard_rate_limit_delay_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_HARD_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "hard_rate_limit_delay_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::SOFT_RATE_LIMIT_DELAY_COUNT :
-            STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "soft_rate_limit_delay_median"})
-                    .Set(value.median);
-            STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "soft_rate_limit_delay_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "soft_rate_limit_delay_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "soft_rate_limit_delay_average"})
-                    .Set(value.average);
-            STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "soft_rate_limit_delay_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_SOFT_RATE_LIMIT_DELAY_COUNT_VEC
-                    .WithLabelValues({name, "soft_rate_limit_delay_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::NUM_FILES_IN_SINGLE_COMPACTION :
-            STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC
-                    .WithLabelValues({name, "num_files_in_single_compaction_median"})
-                    .Set(value.median);
-            STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC
-                    .WithLabelValues({name, "num_files_in_single_compaction_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC
-                    .WithLabelValues({name, "num_files_in_single_compaction_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC
-                    .WithLabelValues({name, "num_files_in_single_compaction_average"})
-                    .Set(value.average);
-            STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC
-                    .WithLabelValues({name, "num_files_in_single_compaction_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_NUM_FILES_IN_SINGLE_COMPACTION_VEC
-                    .WithLabelValues({name, "num_files_in_single_compaction_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::DB_SEEK :
-            STORE_ENGINE_SEEK_MICROS_VEC
-                    .WithLabelValues({name, "seek_median"})
-                    .Set(value.median);
-            STORE_ENGINE_SEEK_MICROS_VEC
-                    .WithLabelValues({name, "seek_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_SEEK_MICROS_VEC
-                    .WithLabelValues({name, "seek_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_SEEK_MICROS_VEC
-                    .WithLabelValues({name, "seek_average"})
-                    .Set(value.average);
-            STORE_ENGINE_SEEK_MICROS_VEC
-                    .WithLabelValues({name, "seek_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_SEEK_MICROS_VEC
-                    .WithLabelValues({name, "seek_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::WRITE_STALL :
-            STORE_ENGINE_WRITE_STALL_VEC
-                    .WithLabelValues({name, "write_stall_median"})
-                    .Set(value.median);
-            STORE_ENGINE_WRITE_STALL_VEC
-                    .WithLabelValues({name, "write_stall_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_WRITE_STALL_VEC
-                    .WithLabelValues({name, "write_stall_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_WRITE_STALL_VEC
-                    .WithLabelValues({name, "write_stall_average"})
-                    .Set(value.average);
-            STORE_ENGINE_WRITE_STALL_VEC
-                    .WithLabelValues({name, "write_stall_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_WRITE_STALL_VEC
-                    .WithLabelValues({name, "write_stall_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::SST_READ_MICROS :
-            STORE_ENGINE_SST_READ_MICROS_VEC
-                    .WithLabelValues({name, "sst_read_micros_median"})
-                    .Set(value.median);
-            STORE_ENGINE_SST_READ_MICROS_VEC
-                    .WithLabelValues({name, "sst_read_micros_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_SST_READ_MICROS_VEC
-                    .WithLabelValues({name, "sst_read_micros_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_SST_READ_MICROS_VEC
-                    .WithLabelValues({name, "sst_read_micros_average"})
-                    .Set(value.average);
-            STORE_ENGINE_SST_READ_MICROS_VEC
-                    .WithLabelValues({name, "sst_read_micros_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_SST_READ_MICROS_VEC
-                    .WithLabelValues({name, "sst_read_micros_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::NUM_SUBCOMPACTIONS_SCHEDULED :
-            STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC
-                    .WithLabelValues({name, "num_subcompaction_scheduled_median"})
-                    .Set(value.median);
-            STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC
-                    .WithLabelValues({name, "num_subcompaction_scheduled_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC
-                    .WithLabelValues({name, "num_subcompaction_scheduled_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC
-                    .WithLabelValues({name, "num_subcompaction_scheduled_average"})
-                    .Set(value.average);
-            STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC
-                    .WithLabelValues({name, "num_subcompaction_scheduled_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_NUM_SUBCOMPACTION_SCHEDULED_VEC
-                    .WithLabelValues({name, "num_subcompaction_scheduled_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::BYTES_PER_READ :
-            STORE_ENGINE_BYTES_PER_READ_VEC
-                    .WithLabelValues({name, "bytes_per_read_median"})
-                    .Set(value.median);
-            STORE_ENGINE_BYTES_PER_READ_VEC
-                    .WithLabelValues({name, "bytes_per_read_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_BYTES_PER_READ_VEC
-                    .WithLabelValues({name, "bytes_per_read_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_BYTES_PER_READ_VEC
-                    .WithLabelValues({name, "bytes_per_read_average"})
-                    .Set(value.average);
-            STORE_ENGINE_BYTES_PER_READ_VEC
-                    .WithLabelValues({name, "bytes_per_read_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_BYTES_PER_READ_VEC
-                    .WithLabelValues({name, "bytes_per_read_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::BYTES_PER_WRITE :
-            STORE_ENGINE_BYTES_PER_WRITE_VEC
-                    .WithLabelValues({name, "bytes_per_write_median"})
-                    .Set(value.median);
-            STORE_ENGINE_BYTES_PER_WRITE_VEC
-                    .WithLabelValues({name, "bytes_per_write_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_BYTES_PER_WRITE_VEC
-                    .WithLabelValues({name, "bytes_per_write_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_BYTES_PER_WRITE_VEC
-                    .WithLabelValues({name, "bytes_per_write_average"})
-                    .Set(value.average);
-            STORE_ENGINE_BYTES_PER_WRITE_VEC
-                    .WithLabelValues({name, "bytes_per_write_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_BYTES_PER_WRITE_VEC
-                    .WithLabelValues({name, "bytes_per_write_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::BYTES_COMPRESSED :
-            STORE_ENGINE_BYTES_COMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_compressed_median"})
-                    .Set(value.median);
-            STORE_ENGINE_BYTES_COMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_compressed_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_BYTES_COMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_compressed_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_BYTES_COMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_compressed_average"})
-                    .Set(value.average);
-            STORE_ENGINE_BYTES_COMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_compressed_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_BYTES_COMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_compressed_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::BYTES_DECOMPRESSED :
-            STORE_ENGINE_BYTES_DECOMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_decompressed_median"})
-                    .Set(value.median);
-            STORE_ENGINE_BYTES_DECOMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_decompressed_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_BYTES_DECOMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_decompressed_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_BYTES_DECOMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_decompressed_average"})
-                    .Set(value.average);
-            STORE_ENGINE_BYTES_DECOMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_decompressed_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_BYTES_DECOMPRESSED_VEC
-                    .WithLabelValues({name, "bytes_decompressed_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::COMPRESSION_TIMES_NANOS :
-            STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "compression_time_nanos_median"})
-                    .Set(value.median);
-            STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "compression_time_nanos_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "compression_time_nanos_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "compression_time_nanos_average"})
-                    .Set(value.average);
-            STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "compression_time_nanos_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "compression_time_nanos_max"})
-                    .Set(value.max);
-            break;
-        case rocksdb::Histograms::DECOMPRESSION_TIMES_NANOS :
-            STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "decompression_time_nanos_median"})
-                    .Set(value.median);
-            STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "decompression_time_nanos_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "decompression_time_nanos_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "decompression_time_nanos_average"})
-                    .Set(value.average);
-            STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "decompression_time_nanos_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC
-                    .WithLabelValues({name, "decompression_time_nanos_max"})
-                    .Set(value.max);
-            break;
-
-        case rocksdb::Histograms::READ_NUM_MERGE_OPERANDS :
-            STORE_ENGINE_READ_MERGE_OPERANDS
-                    .WithLabelValues({name, "read_num_merge_operands_median"})
-                    .Set(value.median);
-            STORE_ENGINE_READ_MERGE_OPERANDS
-                    .WithLabelValues({name, "read_num_merge_operands_percentile95"})
-                    .Set(value.percentile95);
-            STORE_ENGINE_READ_MERGE_OPERANDS
-                    .WithLabelValues({name, "read_num_merge_operands_percentile99"})
-                    .Set(value.percentile99);
-            STORE_ENGINE_READ_MERGE_OPERANDS
-                    .WithLabelValues({name, "read_num_merge_operands_average"})
-                    .Set(value.average);
-            STORE_ENGINE_READ_MERGE_OPERANDS
-                    .WithLabelValues({name, "read_num_merge_operands_standard_deviation"})
-                    .Set(value.standard_deviation);
-            STORE_ENGINE_READ_MERGE_OPERANDS
-                    .WithLabelValues({name, "read_num_merge_operands_max"})
-                    .Set(value.max);
-            break;
-        default:
-            break;
+
+RocksdbStatistics::DbMetricHandles &RocksdbStatistics::GetDbMetricHandles(const std::string &name) {
+    std::lock_guard<std::mutex> lock(db_handles_mutex_);
+    auto &handles = db_handles_[name];
+    if (handles) {
+        return *handles;
+    }
+    handles.reset(new DbMetricHandles());
+    for (auto &metric : ticker_metrics_) {
+        auto &counter = metric.type ? metric.family->WithLabelValues({name, metric.type})
+                                    : metric.family->WithLabelValues({name});
+        handles->tickers.push_back(std::make_pair(metric.ticker, &counter));
+    }
+    for (auto &metric : histogram_metrics_) {
+        std::string type = metric.type;
+        HistogramGauges gauges;
+        gauges.histogram = metric.histogram;
+        gauges.median = &metric.family->WithLabelValues({name, type + "_median"});
+        gauges.percentile95 = &metric.family->WithLabelValues({name, type + "_percentile95"});
+        gauges.percentile99 = &metric.family->WithLabelValues({name, type + "_percentile99"});
+        gauges.average = &metric.family->WithLabelValues({name, type + "_average"});
+        gauges.standard_deviation = &metric.family->WithLabelValues({name, type + "_standard_deviation"});
+        gauges.max = &metric.family->WithLabelValues({name, type + "_max"});
+        handles->histograms.push_back(gauges);
     }
+    handles->filter_false_positive_rate = full_filter_
+                                          ? &STORE_ENGINE_FILTER_FALSE_POSITIVE_RATE_VEC.WithLabelValues({name})
+                                          : nullptr;
+    handles->compress_cost = &STORE_ENGINE_COMPRESSION_COST_VEC.WithLabelValues({name, "compress"});
+    handles->decompress_cost = &STORE_ENGINE_COMPRESSION_COST_VEC.WithLabelValues({name, "decompress"});
+    return *handles;
 }
 
 void RocksdbStatistics::FlushEngineProperties(rocksdb::DB &db, const std::string &name,
@@ -1006,16 +613,33 @@ void RocksdbStatistics::FlushEngineProperties(rocksdb::DB &db, const std::string
     static const std::string ROCKSDB_TABLE_READERS_MEM = rocksdb::DB::Properties::kEstimateTableReadersMem;
     static const std::string ROCKSDB_CUR_SIZE_ALL_MEM_TABLES = rocksdb::DB::Properties::kCurSizeAllMemTables;
     static const std::string ROCKSDB_ESTIMATE_NUM_KEYS = rocksdb::DB::Properties::kEstimateNumKeys;
+    static const std::string ROCKSDB_ESTIMATE_LIVE_DATA_SIZE = rocksdb::DB::Properties::kEstimateLiveDataSize;
     static const std::string ROCKSDB_PENDING_COMPACTION_BYTES = rocksdb::DB::Properties::kEstimatePendingCompactionBytes;
     static const std::string ROCKSDB_NUM_SNAPSHOTS = rocksdb::DB::Properties::kNumSnapshots;
     static const std::string ROCKSDB_OLDEST_SNAPSHOT_TIME = rocksdb::DB::Properties::kOldestSnapshotTime;
     static const std::string ROCKSDB_NUM_IMMUTABLE_MEM_TABLE = rocksdb::DB::Properties::kNumImmutableMemTable;
     static const std::string ROCKSDB_BLOCK_CACHE_USAGE = rocksdb::DB::Properties::kBlockCacheUsage;
+    static const std::string ROCKSDB_BLOCK_CACHE_PINNED_USAGE = rocksdb::DB::Properties::kBlockCachePinnedUsage;
+    static const std::string ROCKSDB_BLOCK_CACHE_CAPACITY = rocksdb::DB::Properties::kBlockCacheCapacity;
+    static const std::string ROCKSDB_BLOCK_CACHE_ENTRY_STATS = rocksdb::DB::Properties::kBlockCacheEntryStats;
     static const std::string ROCKSDB_COMPRESSION_RATIO_AT_LEVEL = rocksdb::DB::Properties::kCompressionRatioAtLevelPrefix;
     static const std::string ROCKSDB_NUM_FILES_AT_LEVEL = rocksdb::DB::Properties::kNumFilesAtLevelPrefix;
+    static const std::string ROCKSDB_NUM_BLOB_FILES = rocksdb::DB::Properties::kNumBlobFiles;
+    static const std::string ROCKSDB_TOTAL_BLOB_FILE_SIZE = rocksdb::DB::Properties::kTotalBlobFileSize;
+    static const std::string ROCKSDB_LIVE_BLOB_FILE_SIZE = rocksdb::DB::Properties::kLiveBlobFileSize;
+    static const std::string ROCKSDB_CF_STATS = rocksdb::DB::Properties::kCFStats;
+    static const std::string ROCKSDB_NUM_RUNNING_FLUSHES = rocksdb::DB::Properties::kNumRunningFlushes;
+    static const std::string ROCKSDB_NUM_RUNNING_COMPACTIONS = rocksdb::DB::Properties::kNumRunningCompactions;
+    static const std::string ROCKSDB_MEM_TABLE_FLUSH_PENDING = rocksdb::DB::Properties::kMemTableFlushPending;
+    static const std::string ROCKSDB_COMPACTION_PENDING = rocksdb::DB::Properties::kCompactionPending;
+    static const std::string ROCKSDB_LIVE_SST_FILES_SIZE = rocksdb::DB::Properties::kLiveSstFilesSize;
 
 
     uint64_t value;
+    // of every column family together, for the amplifications of the db
+    double flush_compaction_written = 0;
+    uint64_t live_sst_size = 0, live_data_size = 0;
+    uint64_t flush_pending = 0, compaction_pending = 0;
     for (const auto &handle : db_cfs) {
         auto cf = handle->GetName();
         // It is important to monitor each cf's size, especially the "raft" and "lock" column
@@ -1034,13 +658,57 @@ void RocksdbStatistics::FlushEngineProperties(rocksdb::DB &db, const std::string
                     .WithLabelValues({name, cf})
                     .Set(value);
         }
-        // For block cache usage
-        if (db.GetIntProperty(handle, ROCKSDB_BLOCK_CACHE_USAGE, &value)) {
-            STORE_ENGINE_BLOCK_CACHE_USAGE_GAUGE_VEC
-                    .WithLabelValues({name, cf})
+        if (db.GetIntProperty(handle, ROCKSDB_BLOCK_CACHE_PINNED_USAGE, &value)) {
+            STORE_ENGINE_BLOCK_CACHE_BYTES_VEC
+                    .WithLabelValues({name, cf, "pinned_usage"})
+                    .Set(value);
+        }
+        if (db.GetIntProperty(handle, ROCKSDB_BLOCK_CACHE_CAPACITY, &value)) {
+            STORE_ENGINE_BLOCK_CACHE_BYTES_VEC
+                    .WithLabelValues({name, cf, "capacity"})
                     .Set(value);
         }
 
+        // What the block cache holds, by role: how much of it is index/filter (metadata) vs data.
+        // The stats are of the whole cache (shared by the column families and rocksdbs using it),
+        // labeled by the cache id; rocksdb rescans the cache at most every few minutes.
+        std::map<std::string, std::string> entry_stats;
+        if (db.GetMapProperty(handle, ROCKSDB_BLOCK_CACHE_ENTRY_STATS, &entry_stats)) {
+            auto id = entry_stats.find("id");
+            auto cache = id != entry_stats.end() ? id->second : name + "/" + cf;
+            for (const auto &stat : entry_stats) {
+                // count.data-block, bytes.index-block
+                const auto &key = stat.first;
+                const char *type = nullptr;
+                if (key.compare(0, 6, "count.") == 0) {
+                    type = "count";
+                } else if (key.compare(0, 6, "bytes.") == 0) {
+                    type = "bytes";
+                } else {
+                    continue;
+                }
+                STORE_ENGINE_BLOCK_CACHE_ENTRIES_VEC
+                        .WithLabelValues({cache, key.substr(6), type})
+                        .Set(std::atof(stat.second.c_str()));
+            }
+        }
+
+        // Filter and index sizes of all the live ssts, the memory side of the filter tradeoff
+        rocksdb::TablePropertiesCollection tables;
+        if (db.GetPropertiesOfAllTables(handle, &tables).ok()) {
+            uint64_t filter_size = 0, index_size = 0;
+            for (auto &table : tables) {
+                filter_size += table.second->filter_size;
+                index_size += table.second->index_size;
+            }
+            STORE_ENGINE_TABLE_META_SIZE_VEC
+                    .WithLabelValues({name, cf, "filter"})
+                    .Set(filter_size);
+            STORE_ENGINE_TABLE_META_SIZE_VEC
+                    .WithLabelValues({name, cf, "index"})
+                    .Set(index_size);
+        }
+
         // TODO: find a better place to record these metrics.
         // Refer: https://github.com/facebook/rocksdb/wiki/Memory-usage-in-RocksDB
         // For index and filter blocks memory
@@ -1057,14 +725,69 @@ void RocksdbStatistics::FlushEngineProperties(rocksdb::DB &db, const std::string
                     .Set(value);
         }
 
-        // TODO: WithLabelValues cache usage and pinned usage.
-
         if (db.GetIntProperty(handle, ROCKSDB_ESTIMATE_NUM_KEYS, &value)) {
             STORE_ENGINE_ESTIMATE_NUM_KEYS_VEC
                     .WithLabelValues({name, cf})
                     .Set(value);
         }
 
+        // Live data vs sst size shows how much expired/overwritten data waits for compaction
+        if (db.GetIntProperty(handle, ROCKSDB_ESTIMATE_LIVE_DATA_SIZE, &value)) {
+            STORE_ENGINE_ESTIMATE_LIVE_DATA_SIZE_VEC
+                    .WithLabelValues({name, cf})
+                    .Set(value);
+            live_data_size += value;
+        }
+        if (db.GetIntProperty(handle, ROCKSDB_LIVE_SST_FILES_SIZE, &value)) {
+            live_sst_size += value;
+        }
+
+        // The queues of the background pools, 1 if the column family waits for a flush/compaction
+        if (db.GetIntProperty(handle, ROCKSDB_MEM_TABLE_FLUSH_PENDING, &value)) {
+            flush_pending += value;
+        }
+        if (db.GetIntProperty(handle, ROCKSDB_COMPACTION_PENDING, &value)) {
+            compaction_pending += value;
+        }
+
+        // Per level bytes read/written, W-Amp, compaction seconds, files and score, the
+        // "Compaction Stats" table of the LOG
+        std::map<std::string, std::string> cf_stats;
+        if (db.GetMapProperty(handle, ROCKSDB_CF_STATS, &cf_stats)) {
+            for (const auto &stat : cf_stats) {
+                // compaction.L0.ReadGB, compaction.Sum.ReadGB
+                const auto &key = stat.first;
+                if (key.compare(0, 11, "compaction.") != 0) {
+                    continue;
+                }
+                auto dot = key.find('.', 11);
+                if (dot == std::string::npos) {
+                    continue;
+                }
+                auto level = key.substr(11, dot - 11);
+                auto property = key.substr(dot + 1);
+                if (level == "Sum") {
+                    level = "sum";
+                } else if (level.size() > 1 && level[0] == 'L') {
+                    level = level.substr(1);
+                } else {
+                    continue;
+                }
+                for (const auto &level_stat : LEVEL_STATS) {
+                    if (property != level_stat.property) {
+                        continue;
+                    }
+                    auto v = std::atof(stat.second.c_str()) * level_stat.scale;
+                    STORE_ENGINE_LEVEL_STATS_VEC
+                            .WithLabelValues({name, cf, level, level_stat.type})
+                            .Set(v);
+                    if (level == "sum" && property == "WriteGB") {
+                        flush_compaction_written += v;
+                    }
+                }
+            }
+        }
+
         // Pending compaction bytes
         if (db.GetIntProperty(handle, ROCKSDB_PENDING_COMPACTION_BYTES, &value)) {
             STORE_ENGINE_PENDING_COMACTION_BYTES_VEC
@@ -1095,12 +818,89 @@ void RocksdbStatistics::FlushEngineProperties(rocksdb::DB &db, const std::string
             }
         }
 
+        // Sorted runs and size amplification, what universal compaction is triggered by
+        rocksdb::ColumnFamilyMetaData meta;
+        db.GetColumnFamilyMetaData(handle, &meta);
+        uint64_t sorted_runs = 0;
+        uint64_t last_level_size = 0;
+        for (const auto &level : meta.levels) {
+            if (level.level == 0) {
+                sorted_runs += level.files.size();
+            } else if (!level.files.empty()) {
+                sorted_runs++;
+            }
+            if (level.level == 0 && !level.files.empty()) {
+                // level0 files are newest first, the oldest one is the last sorted run
+                last_level_size = level.files.back().size;
+            } else if (!level.files.empty()) {
+                last_level_size = level.size;
+            }
+        }
+        STORE_ENGINE_NUM_SORTED_RUNS_VEC
+                .WithLabelValues({name, cf})
+                .Set(sorted_runs);
+        STORE_ENGINE_SIZE_AMPLIFICATION_VEC
+                .WithLabelValues({name, cf})
+                .Set(last_level_size > 0 ? double(meta.size - last_level_size) / last_level_size : 0);
+
         // Num immutable mem-table
         if (db.GetIntProperty(handle, ROCKSDB_NUM_IMMUTABLE_MEM_TABLE, &value)) {
             STORE_ENGINE_NUM_IMMUTABLE_MEM_TABLE_VEC
                     .WithLabelValues({name, cf})
                     .Set(value);
         }
+
+        // Blob files, total - live is the garbage waiting for gc
+        if (db.GetIntProperty(handle, ROCKSDB_NUM_BLOB_FILES, &value)) {
+            STORE_ENGINE_NUM_BLOB_FILES_VEC
+                    .WithLabelValues({name, cf})
+                    .Set(value);
+        }
+        if (db.GetIntProperty(handle, ROCKSDB_TOTAL_BLOB_FILE_SIZE, &value)) {
+            STORE_ENGINE_BLOB_FILE_SIZE_GAUGE_VEC
+                    .WithLabelValues({name, cf, "total"})
+                    .Set(value);
+        }
+        if (db.GetIntProperty(handle, ROCKSDB_LIVE_BLOB_FILE_SIZE, &value)) {
+            STORE_ENGINE_BLOB_FILE_SIZE_GAUGE_VEC
+                    .WithLabelValues({name, cf, "live"})
+                    .Set(value);
+        }
+    }
+
+    // Running jobs against the waiting column families, waiting with idle threads is not a thread shortage
+    STORE_ENGINE_BACKGROUND_JOBS_VEC
+            .WithLabelValues({name, "flush_pending"})
+            .Set(flush_pending);
+    STORE_ENGINE_BACKGROUND_JOBS_VEC
+            .WithLabelValues({name, "compaction_pending"})
+            .Set(compaction_pending);
+    if (db.GetIntProperty(ROCKSDB_NUM_RUNNING_FLUSHES, &value)) {
+        STORE_ENGINE_BACKGROUND_JOBS_VEC
+                .WithLabelValues({name, "running_flushes"})
+                .Set(value);
+    }
+    if (db.GetIntProperty(ROCKSDB_NUM_RUNNING_COMPACTIONS, &value)) {
+        STORE_ENGINE_BACKGROUND_JOBS_VEC
+                .WithLabelValues({name, "running_compactions"})
+                .Set(value);
+    }
+
+    // Bytes the disk takes for every byte the user writes, and for every live byte
+    auto statistics = db.GetDBOptions().statistics;
+    if (statistics) {
+        auto user_written = statistics->getTickerCount(rocksdb::Tickers::BYTES_WRITTEN);
+        auto wal_written = statistics->getTickerCount(rocksdb::Tickers::WAL_FILE_BYTES);
+        if (user_written > 0) {
+            STORE_ENGINE_AMPLIFICATION_VEC
+                    .WithLabelValues({name, "write"})
+                    .Set((wal_written + flush_compaction_written) / user_written);
+        }
+    }
+    if (live_data_size > 0) {
+        STORE_ENGINE_AMPLIFICATION_VEC
+                .WithLabelValues({name, "space"})
+                .Set(double(live_sst_size) / live_data_size);
     }
 
 // For snapshot
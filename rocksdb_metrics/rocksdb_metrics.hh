@@ -5,20 +5,34 @@
 #pragma once
 
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <rocksdb/db.h>
 #include <rocksdb/statistics.h>
 #include <rocksdb/listener.h>
+#include <rocksdb/cache.h>
+#include <rocksdb/write_buffer_manager.h>
 #include "metrics.hh"
+#include "trace_recorder.hh"
 
 class RocksdbStatistics;
 
 class StatisticsEventListener : public rocksdb::EventListener {
 public:
-    StatisticsEventListener(const std::string &db_name, RocksdbStatistics &statistics)
-            : db_name_(db_name), statistics_(statistics) {}
+    // the flush/compaction jobs and stall changes are also recorded into the trace recorder if not nullptr
+    StatisticsEventListener(const std::string &db_name, RocksdbStatistics &statistics,
+                            TraceRecorder *trace_recorder = nullptr)
+            : db_name_(db_name), statistics_(statistics), trace_recorder_(trace_recorder),
+              trace_pid_(trace_recorder ? trace_recorder->Register(db_name) : 0) {}
+
+    void OnFlushBegin(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) override;
 
     void OnFlushCompleted(rocksdb::DB *db, const rocksdb::FlushJobInfo &info) override;
 
+    void OnCompactionBegin(rocksdb::DB *db, const rocksdb::CompactionJobInfo &info) override;
+
     void OnCompactionCompleted(rocksdb::DB *db,
                                const rocksdb::CompactionJobInfo &info) override;
 
@@ -27,12 +41,62 @@ public:
     void OnStallConditionsChanged(const rocksdb::WriteStallInfo &info) override;
 
 private:
+    // counters of the ssts flushed or compacted to one level
+    struct LevelHandles {
+        prometheus::Counter *cpu_micros;
+        prometheus::Counter *output_bytes;
+        prometheus::Counter *raw_bytes;
+        prometheus::Counter *compressed_bytes;
+        prometheus::Counter *saved_bytes;
+    };
+
+    // metrics of one column family, resolved on its first event, the events come from the
+    // flush and compaction threads so the lazily added children are taken under handles_mutex_
+    struct CfHandles {
+        prometheus::Counter *flush;
+        prometheus::Counter *compaction;
+        prometheus::Counter *ingestion;
+        prometheus::Counter *stall_conditions_changed;
+        prometheus::Histogram *compaction_duration;
+        prometheus::Counter *num_corrupt_keys;
+        prometheus::Counter *dropped_keys;
+        prometheus::Counter *dropped_bytes;
+        prometheus::Counter *replaced_keys;
+        prometheus::Gauge *triggered_writes_slowdown;
+        prometheus::Gauge *triggered_writes_stop;
+        std::map<rocksdb::CompactionReason, prometheus::Counter *> compaction_reasons;
+        std::map<rocksdb::WriteStallCondition, prometheus::Gauge *> stall_conditions;
+        std::map<int, LevelHandles> levels;
+    };
+
+    CfHandles &GetCfHandles(const std::string &cf);
+
+    prometheus::Counter &GetCompactionReasonCounter(const std::string &cf, CfHandles &handles,
+                                                    rocksdb::CompactionReason reason);
+
+    prometheus::Gauge &GetStallConditionGauge(const std::string &cf, CfHandles &handles,
+                                              rocksdb::WriteStallCondition condition);
+
+    LevelHandles &GetLevelHandles(const std::string &cf, CfHandles &handles, int level);
+
     const char *GetCompactionReasonString(rocksdb::CompactionReason compaction_reason);
 
     const char *GetWriteStallConditionString(rocksdb::WriteStallCondition c);
 
+    const char *GetFlushReasonString(rocksdb::FlushReason flush_reason);
+
+    // a trace event of the column family with the time and pid filled
+    TraceEvent NewTraceEvent(char phase, const std::string &name, const std::string &cf);
+
+    // raw key/value bytes and data block bytes of an output sst at the level
+    void RecordCompressionBytes(LevelHandles &level_handles, const rocksdb::TableProperties &props);
+
     std::string db_name_;
     RocksdbStatistics &statistics_;
+    TraceRecorder *trace_recorder_;
+    int trace_pid_;
+    std::mutex handles_mutex_;
+    std::unordered_map<std::string, std::unique_ptr<CfHandles>> cf_handles_;
 };
 
 class RocksdbStatistics : public BaseMetrics {
@@ -43,12 +107,58 @@ public:
     FlushMetrics(rocksdb::DB &db, const std::string &name,
                  const std::vector<rocksdb::ColumnFamilyHandle *> &db_cfs);
 
+    // the shared block cache and write buffer manager, both may be nullptr
+    void FlushMemoryBudget(rocksdb::Cache *cache, rocksdb::WriteBufferManager *write_buffer_manager);
+
+    // the block based (legacy) filter never counts the full filter positives, without full
+    // filters the false positive rate is not exported
+    void SetFullFilter(bool full_filter);
+
+    // annotation of a SetOptions/SetDBOptions call, cf is empty for db options; the value
+    // is no label (one series per value), numeric values go to engine_option_value
+    void RecordOptionChanged(const std::string &name, const std::string &cf,
+                             const std::string &option, const std::string &value);
+
 private:
-    void FlushEngineTickerMetrics(rocksdb::Tickers t, const uint64_t value, const std::string &name);
+    // a ticker flushed into the counter of {db, type} (or {db} without type) of the family
+    struct TickerMetric {
+        rocksdb::Tickers ticker;
+        prometheus::Family<prometheus::Counter> *family;
+        const char *type;
+    };
 
-    void
-    FlushEngineHistogramMetrics(rocksdb::Histograms t, const rocksdb::HistogramData &value,
-                                const std::string &name);
+    // a histogram flushed into the type_median, ..., type_max gauges of the family
+    struct HistogramMetric {
+        rocksdb::Histograms histogram;
+        prometheus::Family<prometheus::Gauge> *family;
+        const char *type;
+    };
+
+    struct HistogramGauges {
+        rocksdb::Histograms histogram;
+        prometheus::Gauge *median;
+        prometheus::Gauge *percentile95;
+        prometheus::Gauge *percentile99;
+        prometheus::Gauge *average;
+        prometheus::Gauge *standard_deviation;
+        prometheus::Gauge *max;
+    };
+
+    // ticker_metrics_ and histogram_metrics_ resolved to the children of one db, a flush
+    // only walks these arrays, no label lookups
+    struct DbMetricHandles {
+        std::vector<std::pair<rocksdb::Tickers, prometheus::Counter *>> tickers;
+        // ticker counts of the last flush of every rocksdb of the name, the counters are increased by the deltas
+        std::map<const rocksdb::DB *, std::vector<uint64_t>> last_tickers;
+        std::vector<HistogramGauges> histograms;
+        // nullptr without full filters
+        prometheus::Gauge *filter_false_positive_rate;
+        prometheus::Gauge *compress_cost;
+        prometheus::Gauge *decompress_cost;
+    };
+
+    // resolved on the first flush of the db
+    DbMetricHandles &GetDbMetricHandles(const std::string &name);
 
     void FlushEngineProperties(rocksdb::DB &db, const std::string &name,
                                const std::vector<rocksdb::ColumnFamilyHandle *> &db_cf);
@@ -67,6 +177,7 @@ public:
     val(STORE_ENGINE_COMPACTION_FLOW_VEC,       "engine_compaction_flow_bytes", "Bytes of read/written during compaction",              "db", "type") \
     val(STORE_ENGINE_COMPACTION_DROP_VEC,       "engine_compaction_key_drop",   "Count the reasons for key drop during compaction",     "db", "type") \
     val(STORE_ENGINE_COMPACTION_NUM_CORRUPT_KEYS_VEC, "engine_compaction_num_corrupt_keys", "Number of corrupt keys during compaction", "db", "cf")   \
+    val(STORE_ENGINE_COMPACTION_DROPPED_VEC,    "engine_compaction_dropped",    "Estimated keys and bytes dropped by compaction for any reason, an upper bound of the ttl expired", "db", "cf", "type") \
     val(STORE_ENGINE_COMPACTION_REASON_VEC,     "engine_compaction_reason",     "Number of compaction reason",                          "db", "cf", "reason") \
     val(STORE_ENGINE_LOCATE_VEC,                "engine_locate",                "Number of calls to seek/next/prev",                    "db", "type") \
     val(STORE_ENGINE_FILE_STATUS_VEC,           "engine_file_status",           "Number of different status of files",                  "db", "type") \
@@ -75,12 +186,19 @@ public:
     val(STORE_ENGINE_WAL_FILE_SYNCED,           "engine_wal_file_synced",       "Number of times WAL sync is done",                     "db")         \
     val(STORE_ENGINE_EVENT_COUNTER_VEC,         "engine_event_total",           "Number of engine events",                              "db", "cf", "type")   \
     val(STORE_ENGINE_MERGE_TOTAL_TIME,          "engine_merge_total_time",      "Time of merge operator",                               "db", "type") \
+    val(STORE_ENGINE_BLOB_FLOW_VEC,             "engine_blob_flow_bytes",       "Bytes of read/written to blob files",                  "db", "type") \
+    val(STORE_ENGINE_BLOB_GC_VEC,               "engine_blob_gc",               "Keys and bytes relocated by blob garbage collection",  "db", "type") \
+    val(STORE_ENGINE_COMPACTION_LEVEL_VEC,      "engine_compaction_level",      "Cpu micros and output bytes of compactions into each level", "db", "cf", "level", "type") \
+    val(STORE_ENGINE_COMPRESSION_BYTES_VEC,     "engine_compression_bytes",     "Raw, compressed and saved bytes of the ssts written to each level", "db", "cf", "level", "type") \
 
 #define _make_gauge_family(val) \
     val(STORE_ENGINE_SIZE_GAUGE_VEC,                "engine_size_bytes",                "Sizes of each column families",                "db", "type") \
     val(STORE_ENGINE_BLOCK_CACHE_USAGE_GAUGE_VEC,   "engine_block_cache_size_bytes",    "Usage of each column families' block cache",   "db", "cf")   \
+    val(STORE_ENGINE_BLOCK_CACHE_BYTES_VEC,         "engine_block_cache_bytes",         "Capacity and pinned usage of each column families' block cache", "db", "cf", "type") \
+    val(STORE_ENGINE_BLOCK_CACHE_ENTRIES_VEC,       "engine_block_cache_entries",       "Count and bytes of the entries of each role (data/index/filter block...) in a block cache", "cache", "role", "type") \
     val(STORE_ENGINE_MEMORY_GAUGE_VEC,              "engine_memory_bytes",              "Sizes of each column families",                "db", "cf", "type")   \
     val(STORE_ENGINE_ESTIMATE_NUM_KEYS_VEC,         "engine_estimate_num_keys",         "Estimate num keys of each column families",    "db", "cf")           \
+    val(STORE_ENGINE_ESTIMATE_LIVE_DATA_SIZE_VEC,   "engine_estimate_live_data_size",   "Estimate live data size of each column families", "db", "cf")        \
     val(STORE_ENGINE_GET_MICROS_VEC,                "engine_get_micro_seconds",         "Histogram of get micros",                      "db", "type")         \
     val(STORE_ENGINE_WRITE_MICROS_VEC,              "engine_write_micro_seconds",       "Histogram of write micros",                    "db", "type")         \
     val(STORE_ENGINE_COMPACTION_TIME_VEC,           "engine_compaction_time",           "Histogram of compaction time",                 "db", "type")         \
@@ -105,13 +223,28 @@ public:
     val(STORE_ENGINE_COMPRESSION_TIMES_NANOS_VEC,   "engine_compression_time_nanos",    "Histogram of compression time nanos",          "db", "type") \
     val(STORE_ENGINE_DECOMPRESSION_TIMES_NANOS_VEC, "engine_decompression_time_nanos",  "Histogram of decompression time nanos",        "db", "type") \
     val(STORE_ENGINE_PENDING_COMACTION_BYTES_VEC,   "engine_pending_compaction_bytes",  "Pending compaction bytes",                     "db", "cf")   \
+    val(STORE_ENGINE_COMPRESSION_COST_VEC,          "engine_compression_nanos_per_byte","Average nanos to compress/decompress one byte", "db", "type") \
+    val(STORE_ENGINE_FILTER_FALSE_POSITIVE_RATE_VEC,"engine_filter_false_positive_rate", "Probes of absent keys passed by the full/ribbon sst filters over all probes of absent keys, not exported with the block based filter", "db") \
+    val(STORE_ENGINE_TABLE_META_SIZE_VEC,           "engine_table_meta_size_bytes",     "Filter and index sizes of the live ssts of each column family", "db", "cf", "type") \
     val(STORE_ENGINE_COMPRESSION_RATIO_VEC,         "engine_compression_ratio",         "Compression ratio at different levels",        "db", "cf", "level") \
     val(STORE_ENGINE_NUM_SNAPSHOTS_GAUGE_VEC,       "engine_num_snapshots",             "Number of unreleased snapshots",               "db") \
     val(STORE_ENGINE_OLDEST_SNAPSHOT_DURATION_GAUGE_VEC,    "engine_oldest_snapshot_duration",                  "Oldest unreleased snapshot duration in seconds", "db") \
     val(STORE_ENGINE_NUM_FILES_AT_LEVEL_VEC,        "engine_num_files_at_level",        "Number of files at each level",                "db", "cf", "level")      \
     val(STORE_ENGINE_NUM_IMMUTABLE_MEM_TABLE_VEC,   "engine_num_immutable_mem_table",   "Number of immutable mem-table",                "db", "cf")               \
     val(STORE_ENGINE_STALL_CONDITIONS_CHANGED_VEC,  "engine_stall_conditions_changed",  "Stall conditions changed of each column family", "db", "cf", "type")     \
-    val(STORE_ENGINE_READ_MERGE_OPERANDS,           "engine_read_merge_operands",       "merge operands of engine read",                  "db", "type")
+    val(STORE_ENGINE_READ_MERGE_OPERANDS,           "engine_read_merge_operands",       "merge operands of engine read",                  "db", "type") \
+    val(STORE_ENGINE_BLOB_FILE_READ_MICROS_VEC,     "engine_blob_file_read_micros",     "Histogram of blob file read micros",             "db", "type") \
+    val(STORE_ENGINE_BLOB_FILE_WRITE_MICROS_VEC,    "engine_blob_file_write_micros",    "Histogram of blob file write micros",            "db", "type") \
+    val(STORE_ENGINE_BLOB_FILE_SIZE_GAUGE_VEC,      "engine_blob_file_size_bytes",      "Total and live size of each column families' blob files", "db", "cf", "type") \
+    val(STORE_ENGINE_NUM_BLOB_FILES_VEC,            "engine_num_blob_files",            "Number of blob files of each column family",     "db", "cf") \
+    val(STORE_ENGINE_NUM_SORTED_RUNS_VEC,           "engine_num_sorted_runs",           "Number of sorted runs, every level0 file and every non-empty level", "db", "cf") \
+    val(STORE_ENGINE_SIZE_AMPLIFICATION_VEC,        "engine_size_amplification",        "Bytes above the last non-empty level over the bytes of it",          "db", "cf") \
+    val(STORE_ENGINE_LEVEL_STATS_VEC,               "engine_level_stats",               "Compaction stats of each level since open (rocksdb.cfstats), level sum is the column family", "db", "cf", "level", "type") \
+    val(STORE_ENGINE_AMPLIFICATION_VEC,             "engine_amplification",             "Write amplification (wal, flush and compaction bytes over user bytes) and space amplification (live sst bytes over live data)", "db", "type") \
+    val(STORE_ENGINE_BACKGROUND_JOBS_VEC,           "engine_background_jobs",           "Running flushes/compactions and column families waiting for a flush/compaction", "db", "type") \
+    val(STORE_ENGINE_MEMORY_BUDGET_VEC,             "engine_memory_budget_bytes",       "Capacity and usage of the shared block cache and write buffer manager", "type") \
+    val(STORE_ENGINE_OPTION_CHANGED_VEC,            "engine_option_changed_timestamp_seconds", "Unix time an option was changed at runtime, cf is empty for db options", "db", "cf", "option") \
+    val(STORE_ENGINE_OPTION_VALUE_VEC,              "engine_option_value",              "Last value set at runtime of the numeric options (booleans as 0/1), cf is empty for db options", "db", "cf", "option")
 
 
 #define _make_histogram_family(val) \
@@ -120,7 +253,11 @@ public:
 private:
     friend StatisticsEventListener;
     std::map<rocksdb::Tickers, const std::string> tickers_names_;
-    std::map<rocksdb::Histograms, const std::string> histograms_names_;
+    std::vector<TickerMetric> ticker_metrics_;
+    std::vector<HistogramMetric> histogram_metrics_;
+    std::mutex db_handles_mutex_;
+    std::unordered_map<std::string, std::unique_ptr<DbMetricHandles>> db_handles_;
+    bool full_filter_;
 
 #define _make_counter_params(param, name, help, label, ...)   \
     prometheus::Family<prometheus::Counter>& param;
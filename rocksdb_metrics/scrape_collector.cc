@@ -0,0 +1,46 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include "scrape_collector.hh"
+
+ScrapeCollector::ScrapeCollector(std::chrono::milliseconds min_interval)
+        : min_interval_(min_interval), cached_(false) {
+}
+
+void ScrapeCollector::Add(const std::weak_ptr<prometheus::Collectable> &collectable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectables_.push_back(collectable);
+    cached_ = false;
+}
+
+void ScrapeCollector::SetCollect(const std::function<void()> &collect) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collect_ = collect;
+    cached_ = false;
+}
+
+std::vector<prometheus::MetricFamily> ScrapeCollector::Collect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    if (cached_ && now - collect_time_ < min_interval_) {
+        return families_;
+    }
+
+    if (collect_) {
+        collect_();
+    }
+    families_.clear();
+    for (auto &collectable : collectables_) {
+        auto c = collectable.lock();
+        if (!c) {
+            continue;
+        }
+        auto families = c->Collect();
+        families_.insert(families_.end(), families.begin(), families.end());
+    }
+    collect_time_ = now;
+    // nothing to cache until the collect function is set
+    cached_ = bool(collect_);
+    return families_;
+}
@@ -0,0 +1,41 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <prometheus/collectable.h>
+#include <prometheus/metric_family.h>
+
+
+/*
+ * Collects the added registries when a scrape arrives instead of a thread flushing them all the
+ * time: the collect function (e.g. RocksdbStatistics::FlushMetrics of every rocksdb) is called,
+ * then the registries are collected. The result is cached for min_interval, concurrent scrapers
+ * wait for the one collecting and share its result.
+ */
+class ScrapeCollector : public prometheus::Collectable {
+public:
+    explicit ScrapeCollector(std::chrono::milliseconds min_interval);
+
+    void Add(const std::weak_ptr<prometheus::Collectable> &collectable);
+
+    // nullptr stops collecting, the registries are still returned as they are
+    void SetCollect(const std::function<void()> &collect);
+
+    std::vector<prometheus::MetricFamily> Collect() override;
+
+private:
+    std::mutex mutex_;
+    std::chrono::milliseconds min_interval_;
+    std::function<void()> collect_;
+    std::vector<std::weak_ptr<prometheus::Collectable>> collectables_;
+    std::vector<prometheus::MetricFamily> families_;
+    std::chrono::steady_clock::time_point collect_time_;
+    bool cached_;
+};
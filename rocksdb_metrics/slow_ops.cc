@@ -0,0 +1,102 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+#include "slow_ops.hh"
+#include "trace_recorder.hh"
+
+SlowOpTracker::SlowOpTracker(size_t capacity, uint64_t threshold_micros)
+        : capacity_(capacity), threshold_micros_(threshold_micros), size_(0), fastest_(0),
+          ops_(new SlowOp[capacity > 0 ? capacity : 1]), seq_(0) {
+}
+
+void SlowOpTracker::Record(const SlowOp &op) {
+    if (!IsSlow(op.latency_micros)) {
+        return;
+    }
+    auto seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (size_ < capacity_) {
+        ops_[size_++] = op;
+    } else {
+        ops_[fastest_] = op;
+    }
+    fastest_ = 0;
+    for (size_t i = 1; i < size_; i++) {
+        if (ops_[i].latency_micros < ops_[fastest_].latency_micros) {
+            fastest_ = i;
+        }
+    }
+    seq_.store(seq + 2, std::memory_order_release);
+}
+
+std::vector<SlowOp> SlowOpTracker::Snapshot() const {
+    std::vector<SlowOp> ops;
+    for (int retry = 0; retry < 100; retry++) {
+        auto seq = seq_.load(std::memory_order_acquire);
+        if (seq % 2 == 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        // size_ only grows under the sequence, a stale one is caught by the check below
+        ops.assign(ops_.get(), ops_.get() + std::min(size_, capacity_));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == seq) {
+            return ops;
+        }
+    }
+    return std::vector<SlowOp>();
+}
+
+
+SlowOpRecorder::SlowOpRecorder(size_t ops_per_thread, uint64_t threshold_micros)
+        : ops_per_thread_(ops_per_thread), threshold_micros_(threshold_micros) {
+}
+
+SlowOpTracker *SlowOpRecorder::NewTracker() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trackers_.emplace_back(new SlowOpTracker(ops_per_thread_, threshold_micros_));
+    return trackers_.back().get();
+}
+
+std::vector<SlowOp> SlowOpRecorder::Snapshot() const {
+    std::vector<SlowOp> ops;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &tracker : trackers_) {
+            auto thread_ops = tracker->Snapshot();
+            ops.insert(ops.end(), thread_ops.begin(), thread_ops.end());
+        }
+    }
+    std::sort(ops.begin(), ops.end(), [](const SlowOp &a, const SlowOp &b) {
+        return a.latency_micros > b.latency_micros;
+    });
+    return ops;
+}
+
+std::string SlowOpRecorder::Dump() const {
+    std::ostringstream out;
+    out << "{\"threshold_micros\":" << threshold_micros_ << ",\"ops_per_thread\":" << ops_per_thread_
+        << ",\"ops\":[";
+    bool first = true;
+    for (const auto &op : Snapshot()) {
+        out << (first ? "" : ",") << "\n{\"unix_micros\":" << op.unix_micros
+            << ",\"latency_micros\":" << op.latency_micros
+            << ",\"type\":\"" << JsonEscape(op.type) << "\""
+            << ",\"db\":\"" << JsonEscape(op.db) << "\""
+            << ",\"cf\":\"" << JsonEscape(op.cf) << "\""
+            << ",\"key\":\"" << JsonEscape(op.key) << "\""
+            << ",\"value_size\":" << op.value_size
+            << ",\"batch_size\":" << op.batch_size
+            << ",\"stall\":\"" << JsonEscape(op.stall) << "\""
+            << ",\"l0_files\":" << op.l0_files
+            << ",\"imm_memtables\":" << op.imm_memtables << "}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return out.str();
+}
@@ -0,0 +1,75 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// a benchmark op slower than the threshold with the engine state right after it
+struct SlowOp {
+    uint64_t unix_micros;
+    uint64_t latency_micros;
+    char type[16];
+    char db[64];
+    char cf[32];
+    char key[64];
+    uint32_t value_size;
+    uint32_t batch_size;
+    // normal, delayed or stopped
+    char stall[16];
+    int64_t l0_files;
+    int64_t imm_memtables;
+};
+
+/*
+ * The slowest ops of one benchmark thread, only that thread records so it never waits; the readers
+ * copy the ops between two equal even sequences and retry otherwise.
+ */
+class SlowOpTracker {
+public:
+    SlowOpTracker(size_t capacity, uint64_t threshold_micros);
+
+    // cheap enough for every op, the engine state is only read for the ops kept
+    bool IsSlow(uint64_t latency_micros) const {
+        return latency_micros >= threshold_micros_ && capacity_ > 0
+               && (size_ < capacity_ || latency_micros > ops_[fastest_].latency_micros);
+    }
+
+    // replaces the fastest kept op when full
+    void Record(const SlowOp &op);
+
+    std::vector<SlowOp> Snapshot() const;
+
+private:
+    size_t capacity_;
+    uint64_t threshold_micros_;
+    size_t size_;
+    size_t fastest_;
+    std::unique_ptr<SlowOp[]> ops_;
+    std::atomic<uint64_t> seq_;
+};
+
+class SlowOpRecorder {
+public:
+    SlowOpRecorder(size_t ops_per_thread, uint64_t threshold_micros);
+
+    // a tracker of a benchmark thread, owned by the recorder
+    SlowOpTracker *NewTracker();
+
+    // the ops of every thread, slowest first
+    std::vector<SlowOp> Snapshot() const;
+
+    std::string Dump() const;
+
+private:
+    size_t ops_per_thread_;
+    uint64_t threshold_micros_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<SlowOpTracker>> trackers_;
+};
@@ -73,3 +73,9 @@ void SystemStatistics::FlushMetrics(const std::string& path) {
             .Set(available);
 
 }
+
+void SystemStatistics::SetRunInfo(const std::string& env, const std::string& bound) {
+    STORE_RUN_INFO_GAUGE_VEC
+            .WithLabelValues({env, bound})
+            .Set(1);
+}
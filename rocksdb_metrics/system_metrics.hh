@@ -13,6 +13,9 @@ public:
     void
     FlushMetrics(const std::string& path);
 
+    // env: default/mem, bound: disk/cpu; every dashboard panel can join on it
+    void SetRunInfo(const std::string& env, const std::string& bound);
+
 public:
 
 #define _sys_make_counter_family(val) \
@@ -21,6 +24,7 @@ public:
 
 #define _sys_make_gauge_family(val) \
     val(STORE_SIZE_GAUGE_VEC,    "store_size_bytes", "Size of storage.", "type") \
+    val(STORE_RUN_INFO_GAUGE_VEC, "trocksdb_run_info", "Run mode of trocksdb, bound=cpu means no disk io.", "env", "bound") \
 
 
 #define _sys_make_histogram_family(val) \
@@ -0,0 +1,127 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <rocksdb/thread_status.h>
+#include "thread_status_metrics.hh"
+#include "prometheus/counter.h"
+#include "prometheus/gauge.h"
+
+static const struct {
+    rocksdb::ThreadStatus::ThreadType type;
+    rocksdb::Env::Priority priority;
+    const char *pool;
+} POOLS[] = {
+        {rocksdb::ThreadStatus::HIGH_PRIORITY,   rocksdb::Env::Priority::HIGH,   "high"},
+        {rocksdb::ThreadStatus::LOW_PRIORITY,    rocksdb::Env::Priority::LOW,    "low"},
+        {rocksdb::ThreadStatus::BOTTOM_PRIORITY, rocksdb::Env::Priority::BOTTOM, "bottom"},
+};
+
+
+ThreadStatusStatistics::ThreadStatusStatistics()
+        : BaseMetrics(),
+#define _thread_status_init_counter_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildCounter() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .Register(*registry_) \
+    ),
+        _thread_status_make_counter_family(_thread_status_init_counter_familys)
+
+#define _thread_status_init_gauge_familys(param, name, help, label, ...)   \
+    param(prometheus::BuildGauge() \
+    .Name(name) \
+    .Help(help) \
+    .LabelNamesVec({label, __VA_ARGS__}) \
+    .Register(*registry_) \
+    ),
+        _thread_status_make_gauge_family(_thread_status_init_gauge_familys)
+
+        stop_(false) {
+}
+
+ThreadStatusStatistics::~ThreadStatusStatistics() {
+    Stop();
+}
+
+void ThreadStatusStatistics::Start(rocksdb::Env *env, std::chrono::milliseconds interval) {
+    thread_ = std::thread(std::bind(&ThreadStatusStatistics::Sample, this, env, interval));
+}
+
+void ThreadStatusStatistics::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+ThreadStatusStatistics::BusyState &ThreadStatusStatistics::GetBusyState(const char *pool,
+                                                                        const std::string &operation,
+                                                                        const std::string &stage) {
+    auto key = std::string(pool) + "/" + operation + "/" + stage;
+    auto it = busy_states_.find(key);
+    if (it != busy_states_.end()) {
+        return it->second;
+    }
+    BusyState state;
+    state.busy_seconds = &STORE_THREAD_BUSY_SECONDS_VEC.WithLabelValues({pool, operation, stage});
+    state.busy_fraction = &STORE_THREAD_BUSY_FRACTION_VEC.WithLabelValues({pool, operation, stage});
+    state.pool = pool;
+    state.busy = 0;
+    return busy_states_.insert(std::make_pair(key, state)).first->second;
+}
+
+void ThreadStatusStatistics::Sample(rocksdb::Env *env, std::chrono::milliseconds interval) {
+    double interval_seconds = interval.count() / 1000.0;
+    auto window_samples = std::max<int64_t>(1, 1000 / std::max<int64_t>(1, interval.count()));
+    int64_t samples = 0;
+    std::map<std::string, int> pool_threads;
+    std::vector<rocksdb::ThreadStatus> threads;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, interval, [this] { return stop_; })) {
+        threads.clear();
+        if (!env->GetThreadList(&threads).ok()) {
+            continue;
+        }
+        for (const auto &thread : threads) {
+            if (thread.operation_type == rocksdb::ThreadStatus::OP_UNKNOWN) {
+                continue;
+            }
+            for (const auto &pool : POOLS) {
+                if (pool.type != thread.thread_type) {
+                    continue;
+                }
+                auto &state = GetBusyState(pool.pool,
+                                           rocksdb::ThreadStatus::GetOperationName(thread.operation_type),
+                                           rocksdb::ThreadStatus::GetOperationStageName(thread.operation_stage));
+                state.busy_seconds->Increment(interval_seconds);
+                state.busy++;
+            }
+        }
+
+        // the fractions of the last second, the threads of a pool may be changed at runtime
+        if (++samples < window_samples) {
+            continue;
+        }
+        for (const auto &pool : POOLS) {
+            pool_threads[pool.pool] = env->GetBackgroundThreads(pool.priority);
+            STORE_THREAD_POOL_THREADS_VEC.WithLabelValues({pool.pool}).Set(pool_threads[pool.pool]);
+        }
+        for (auto &pair : busy_states_) {
+            auto &state = pair.second;
+            auto threads_num = pool_threads[state.pool];
+            state.busy_fraction->Set(threads_num > 0 ? double(state.busy) / (samples * threads_num) : 0);
+            state.busy = 0;
+        }
+        samples = 0;
+    }
+}
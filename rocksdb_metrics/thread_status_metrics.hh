@@ -0,0 +1,66 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <rocksdb/env.h>
+#include "metrics.hh"
+
+/*
+ * Samples Env::GetThreadList (options.enable_thread_tracking) of the flush/compaction pools every
+ * interval, the busy threads of every pool, operation and stage are counted into busy seconds and,
+ * over every second, into the busy fraction of the pool. A pool always near 1 is saturated, more
+ * background threads may help; a pool near 0 with pending compactions waits for something else.
+ */
+class ThreadStatusStatistics : public BaseMetrics {
+public:
+    ThreadStatusStatistics();
+
+    ~ThreadStatusStatistics();
+
+    void Start(rocksdb::Env *env, std::chrono::milliseconds interval);
+
+    void Stop();
+
+#define _thread_status_make_counter_family(val) \
+    val(STORE_THREAD_BUSY_SECONDS_VEC,      "engine_thread_busy_seconds",   "Sampled seconds the background threads spent in each operation and stage", "pool", "operation", "stage") \
+
+
+#define _thread_status_make_gauge_family(val) \
+    val(STORE_THREAD_BUSY_FRACTION_VEC,     "engine_thread_busy_fraction",  "Busy threads over the threads of the pool in the last second, of each operation and stage", "pool", "operation", "stage") \
+    val(STORE_THREAD_POOL_THREADS_VEC,      "engine_thread_pool_threads",   "Threads of each background pool",          "pool") \
+
+
+private:
+    // busy threads of a pool, operation and stage summed over the samples of the second
+    struct BusyState {
+        prometheus::Counter *busy_seconds;
+        prometheus::Gauge *busy_fraction;
+        const char *pool;
+        uint64_t busy;
+    };
+
+    void Sample(rocksdb::Env *env, std::chrono::milliseconds interval);
+
+    BusyState &GetBusyState(const char *pool, const std::string &operation, const std::string &stage);
+
+#define _thread_status_make_counter_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Counter>& param;
+    _thread_status_make_counter_family(_thread_status_make_counter_params)
+#define _thread_status_make_gauge_params(param, name, help, label, ...)   \
+    prometheus::Family<prometheus::Gauge>& param;
+    _thread_status_make_gauge_family(_thread_status_make_gauge_params)
+
+    std::map<std::string, BusyState> busy_states_;
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_;
+    std::thread thread_;
+};
@@ -0,0 +1,114 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include "trace_recorder.hh"
+
+std::string JsonEscape(const char *str) {
+    std::string result;
+    for (auto p = str; *p; p++) {
+        auto c = *p;
+        if (c == '"' || c == '\\') {
+            result.push_back('\\');
+            result.push_back(c);
+        } else if ((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            result += buf;
+        } else {
+            result.push_back(c);
+        }
+    }
+    return result;
+}
+
+TraceRecorder::TraceRecorder(size_t capacity)
+        : capacity_(capacity), slots_(new Slot[capacity]), next_(0),
+          start_(std::chrono::steady_clock::now()) {
+    for (size_t i = 0; i < capacity_; i++) {
+        slots_[i].seq.store(0, std::memory_order_relaxed);
+    }
+}
+
+int TraceRecorder::Register(const std::string &db_name) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    names_.push_back(db_name);
+    return int(names_.size()) - 1;
+}
+
+uint64_t TraceRecorder::NowMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_).count();
+}
+
+void TraceRecorder::Record(const TraceEvent &event) {
+    auto index = next_.fetch_add(1, std::memory_order_relaxed);
+    auto &slot = slots_[index % capacity_];
+    slot.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.seq.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> TraceRecorder::Snapshot() const {
+    std::vector<TraceEvent> events;
+    auto end = next_.load(std::memory_order_acquire);
+    auto begin = end > capacity_ ? end - capacity_ : 0;
+    for (auto index = begin; index < end; index++) {
+        auto &slot = slots_[index % capacity_];
+        // skip the slots being written or already taken by a newer event
+        if (slot.seq.load(std::memory_order_acquire) != index + 1) {
+            continue;
+        }
+        TraceEvent event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != index + 1) {
+            continue;
+        }
+        events.push_back(event);
+    }
+    return events;
+}
+
+std::string TraceRecorder::Dump() const {
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    {
+        std::lock_guard<std::mutex> lock(names_mutex_);
+        for (size_t pid = 0; pid < names_.size(); pid++) {
+            out << (first ? "" : ",") << "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+                << ",\"args\":{\"name\":\"" << JsonEscape(names_[pid].c_str()) << "\"}}";
+            first = false;
+        }
+    }
+    for (const auto &event : Snapshot()) {
+        out << (first ? "" : ",") << "\n{\"name\":\"" << JsonEscape(event.name) << "\",\"cat\":\"rocksdb\""
+            << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.micros << ",\"pid\":" << event.pid
+            << ",\"tid\":" << event.tid << ",\"args\":{";
+        if (event.phase == 'C') {
+            out << "\"state\":" << event.value;
+        } else if (event.phase == 'B') {
+            out << "\"cf\":\"" << JsonEscape(event.cf) << "\",\"reason\":\"" << JsonEscape(event.reason)
+                << "\",\"job_id\":" << event.job_id << ",\"input_level\":" << event.input_level
+                << ",\"output_level\":" << event.output_level << ",\"input_files\":" << event.input_files;
+        } else {
+            out << "\"input_files\":" << event.input_files << ",\"output_files\":" << event.output_files
+                << ",\"input_bytes\":" << event.input_bytes << ",\"output_bytes\":" << event.output_bytes;
+        }
+        out << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+void TraceRecorder::CopyName(char *dest, size_t size, const std::string &src) {
+    auto n = std::min(size - 1, src.size());
+    memcpy(dest, src.data(), n);
+    dest[n] = '\0';
+}
@@ -0,0 +1,76 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// escapes a string for the json dumps
+std::string JsonEscape(const char *str);
+
+// a flush/compaction job begin or end, or a stall condition change of a column family
+struct TraceEvent {
+    // 'B' begin and 'E' end of a job on its thread, 'C' stall state (0 normal, 1 delayed, 2 stopped)
+    char phase;
+    char name[32];
+    char cf[32];
+    char reason[32];
+    int pid;
+    uint64_t tid;
+    uint64_t micros;
+    uint64_t job_id;
+    int input_level;
+    int output_level;
+    uint64_t input_files;
+    uint64_t output_files;
+    uint64_t input_bytes;
+    uint64_t output_bytes;
+    int64_t value;
+};
+
+/*
+ * The last capacity events of every rocksdb in a ring, Record is lock free (a slot is claimed by
+ * a fetch_add and published by its sequence) so the flush/compaction threads never wait on it.
+ * Dump is the chrome trace json (chrome://tracing, ui.perfetto.dev): a process a rocksdb, the jobs
+ * on the thread ran them, the stall states as counters on the same timeline.
+ */
+class TraceRecorder {
+public:
+    explicit TraceRecorder(size_t capacity);
+
+    // the pid of the events of a rocksdb
+    int Register(const std::string &db_name);
+
+    // micros since the recorder is created
+    uint64_t NowMicros() const;
+
+    void Record(const TraceEvent &event);
+
+    std::vector<TraceEvent> Snapshot() const;
+
+    std::string Dump() const;
+
+    // copies at most size - 1 chars and terminates
+    static void CopyName(char *dest, size_t size, const std::string &src);
+
+private:
+    struct Slot {
+        // index + 1 of the event in it, 0 while it is written
+        std::atomic<uint64_t> seq;
+        TraceEvent event;
+    };
+
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> next_;
+    std::chrono::steady_clock::time_point start_;
+    mutable std::mutex names_mutex_;
+    std::vector<std::string> names_;
+};
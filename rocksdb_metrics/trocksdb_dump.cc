@@ -0,0 +1,89 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+/*
+ * Exports the file of trocksdb --tsdb_file to csv (timestamp_ms,series,value), the rows are in
+ * chunks of one series, sort them by time if needed:
+ *   trocksdb_dump --file=trocksdb.tsdb --list
+ *   trocksdb_dump --file=trocksdb.tsdb --match=compaction_pending > pending.csv
+ *   trocksdb_dump --file=trocksdb.tsdb --from_ms=1700000000000 --to_ms=1700003600000 | sort -n > hour.csv
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <gflags/gflags.h>
+#include "tsdb_format.hh"
+
+DEFINE_string(file, "trocksdb.tsdb", "the file written by trocksdb --tsdb_file");
+DEFINE_string(match, "", "only the series containing it, e.g. a metric name or db=\"rocks0\", empty all");
+DEFINE_int64(from_ms, 0, "only the samples at or after it (unix ms), 0 from the start");
+DEFINE_int64(to_ms, 0, "only the samples before it (unix ms), 0 to the end");
+DEFINE_bool(list, false, "print the matched series and their sample counts instead of the samples");
+
+static std::string CsvQuote(const std::string &str) {
+    std::string result = "\"";
+    for (auto c : str) {
+        if (c == '"') {
+            result.push_back('"');
+        }
+        result.push_back(c);
+    }
+    result.push_back('"');
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    GFLAGS_NAMESPACE::SetUsageMessage("trocksdb_dump --file=trocksdb.tsdb [--match=] [--from_ms=] [--to_ms=] [--list]");
+    GFLAGS_NAMESPACE::ParseCommandLineFlags(&argc, &argv, true);
+
+    TsdbReader reader;
+    if (!reader.Open(FLAGS_file)) {
+        std::cout << "Error of params, " << FLAGS_file << " is not a trocksdb tsdb file" << std::endl;
+        exit(-1);
+    }
+
+    // id -> series, only the matched ones
+    std::unordered_map<uint64_t, std::string> series;
+    std::unordered_map<uint64_t, uint64_t> counts;
+    std::vector<std::pair<int64_t, double>> samples;
+    TsdbReader::Record record;
+    std::cout << std::setprecision(15);
+    if (!FLAGS_list) {
+        std::cout << "timestamp_ms,series,value" << std::endl;
+    }
+    while (reader.Next(&record)) {
+        if (record.type == 'S') {
+            if (FLAGS_match.empty() || record.data.find(FLAGS_match) != std::string::npos) {
+                series[record.id] = FLAGS_list ? record.data : CsvQuote(record.data);
+            }
+            continue;
+        }
+        auto it = series.find(record.id);
+        if (it == series.end()) {
+            continue;
+        }
+        if (FLAGS_list) {
+            counts[record.id] += record.count;
+            continue;
+        }
+        samples.clear();
+        if (!DecodeTsdbChunk(record.data, record.count, &samples)) {
+            std::cerr << "broken chunk of " << it->second << ", skipped" << std::endl;
+            continue;
+        }
+        for (auto &sample : samples) {
+            if (sample.first < FLAGS_from_ms || (FLAGS_to_ms > 0 && sample.first >= FLAGS_to_ms)) {
+                continue;
+            }
+            std::cout << sample.first << "," << it->second << "," << sample.second << "\n";
+        }
+    }
+    if (FLAGS_list) {
+        for (auto &pair : series) {
+            std::cout << pair.second << " " << counts[pair.first] << std::endl;
+        }
+    }
+    return 0;
+}
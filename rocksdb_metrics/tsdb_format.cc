@@ -0,0 +1,246 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <cstring>
+#include "tsdb_format.hh"
+
+void TsdbBitWriter::Write(uint64_t value, int nbits) {
+    while (nbits > 0) {
+        if (bits_ == 0) {
+            data_.push_back(0);
+        }
+        int n = std::min(nbits, 8 - bits_);
+        auto byte = uint8_t((value >> (nbits - n)) & ((1u << n) - 1));
+        data_.back() = char(uint8_t(data_.back()) | uint8_t(byte << (8 - bits_ - n)));
+        bits_ = (bits_ + n) % 8;
+        nbits -= n;
+    }
+}
+
+void TsdbBitWriter::Clear() {
+    data_.clear();
+    bits_ = 0;
+}
+
+bool TsdbBitReader::Read(int nbits, uint64_t *value) {
+    if (pos_ + nbits > data_.size() * 8) {
+        return false;
+    }
+    uint64_t result = 0;
+    while (nbits > 0) {
+        auto used = int(pos_ % 8);
+        int n = std::min(nbits, 8 - used);
+        auto byte = uint8_t(data_[pos_ / 8]);
+        result = (result << n) | ((byte >> (8 - used - n)) & ((1u << n) - 1));
+        pos_ += n;
+        nbits -= n;
+    }
+    *value = result;
+    return true;
+}
+
+
+static uint64_t DoubleBits(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static double BitsDouble(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+TsdbChunkEncoder::TsdbChunkEncoder() {
+    Clear();
+}
+
+void TsdbChunkEncoder::Clear() {
+    bits_.Clear();
+    count_ = 0;
+    last_timestamp_ = 0;
+    last_delta_ = 0;
+    last_value_ = 0;
+    leading_ = -1;
+    trailing_ = 0;
+}
+
+void TsdbChunkEncoder::Append(int64_t timestamp_ms, double value) {
+    auto bits = DoubleBits(value);
+    if (count_ == 0) {
+        bits_.Write(uint64_t(timestamp_ms), 64);
+        bits_.Write(bits, 64);
+        last_timestamp_ = timestamp_ms;
+        last_value_ = bits;
+        count_++;
+        return;
+    }
+
+    auto delta = timestamp_ms - last_timestamp_;
+    auto dod = delta - last_delta_;
+    if (dod == 0) {
+        bits_.Write(0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        bits_.Write(0x2, 2);
+        bits_.Write(uint64_t(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+        bits_.Write(0x6, 3);
+        bits_.Write(uint64_t(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        bits_.Write(0xe, 4);
+        bits_.Write(uint64_t(dod + 2047), 12);
+    } else {
+        bits_.Write(0xf, 4);
+        bits_.Write(uint64_t(dod), 64);
+    }
+    last_timestamp_ = timestamp_ms;
+    last_delta_ = delta;
+
+    auto xor_bits = bits ^ last_value_;
+    last_value_ = bits;
+    if (xor_bits == 0) {
+        bits_.Write(0, 1);
+    } else {
+        int leading = std::min(__builtin_clzll(xor_bits), 31);
+        int trailing = __builtin_ctzll(xor_bits);
+        if (leading_ >= 0 && leading >= leading_ && trailing >= trailing_) {
+            // inside the meaningful bits of the last one
+            bits_.Write(0x2, 2);
+            bits_.Write(xor_bits >> trailing_, 64 - leading_ - trailing_);
+        } else {
+            auto meaningful = 64 - leading - trailing;
+            bits_.Write(0x3, 2);
+            bits_.Write(uint64_t(leading), 5);
+            bits_.Write(uint64_t(meaningful - 1), 6);
+            bits_.Write(xor_bits >> trailing, meaningful);
+            leading_ = leading;
+            trailing_ = trailing;
+        }
+    }
+    count_++;
+}
+
+bool DecodeTsdbChunk(const std::string &data, size_t count, std::vector<std::pair<int64_t, double>> *samples) {
+    TsdbBitReader reader(data);
+    uint64_t timestamp, value, bit;
+    int64_t delta = 0;
+    int leading = 0, meaningful = 64;
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0) {
+            if (!reader.Read(64, &timestamp) || !reader.Read(64, &value)) {
+                return false;
+            }
+            samples->push_back(std::make_pair(int64_t(timestamp), BitsDouble(value)));
+            continue;
+        }
+
+        // the 1 bits before a 0 choose the size of the delta of delta, at most 4
+        int ones = 0;
+        while (ones < 4) {
+            if (!reader.Read(1, &bit)) {
+                return false;
+            }
+            if (bit == 0) {
+                break;
+            }
+            ones++;
+        }
+        static const int DOD_BITS[] = {0, 7, 9, 12, 64};
+        static const int64_t DOD_BIAS[] = {0, 63, 255, 2047, 0};
+        uint64_t dod = 0;
+        if (ones > 0 && !reader.Read(DOD_BITS[ones], &dod)) {
+            return false;
+        }
+        delta += int64_t(dod) - DOD_BIAS[ones];
+        timestamp += uint64_t(delta);
+
+        if (!reader.Read(1, &bit)) {
+            return false;
+        }
+        if (bit == 1) {
+            uint64_t control, xor_bits;
+            if (!reader.Read(1, &control)) {
+                return false;
+            }
+            if (control == 1) {
+                uint64_t l, m;
+                if (!reader.Read(5, &l) || !reader.Read(6, &m)) {
+                    return false;
+                }
+                leading = int(l);
+                meaningful = int(m) + 1;
+            }
+            if (!reader.Read(meaningful, &xor_bits)) {
+                return false;
+            }
+            value ^= xor_bits << (64 - leading - meaningful);
+        }
+        samples->push_back(std::make_pair(int64_t(timestamp), BitsDouble(value)));
+    }
+    return true;
+}
+
+void PutVarint(std::string *out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(char(value | 0x80));
+        value >>= 7;
+    }
+    out->push_back(char(value));
+}
+
+
+TsdbReader::TsdbReader() : file_(nullptr) {
+}
+
+TsdbReader::~TsdbReader() {
+    if (file_) {
+        fclose(file_);
+    }
+}
+
+bool TsdbReader::Open(const std::string &path) {
+    file_ = fopen(path.c_str(), "rb");
+    if (!file_) {
+        return false;
+    }
+    char magic[TSDB_MAGIC_SIZE];
+    return fread(magic, 1, TSDB_MAGIC_SIZE, file_) == TSDB_MAGIC_SIZE
+           && memcmp(magic, TSDB_MAGIC, TSDB_MAGIC_SIZE) == 0;
+}
+
+bool TsdbReader::GetVarint(uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file_);
+        if (c == EOF) {
+            return false;
+        }
+        *value |= uint64_t(c & 0x7f) << shift;
+        if ((c & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TsdbReader::Next(Record *record) {
+    int type = fgetc(file_);
+    if (type != 'S' && type != 'C') {
+        return false;
+    }
+    record->type = char(type);
+    record->count = 0;
+    uint64_t length;
+    if (!GetVarint(&record->id)
+        || (type == 'C' && !GetVarint(&record->count))
+        || !GetVarint(&length)
+        // a torn length is never this big
+        || length > (uint64_t(1) << 30)) {
+        return false;
+    }
+    record->data.resize(length);
+    return length == 0 || fread(&record->data[0], 1, length, file_) == length;
+}
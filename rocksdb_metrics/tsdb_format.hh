@@ -0,0 +1,109 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * The file of TsdbRecorder, a magic then records appended one after another:
+ *   'S' varint id, varint length, series     -- a new series, name{label="value",...}
+ *   'C' varint id, varint count, varint length, bits -- a chunk of count samples of a series
+ * A chunk is the gorilla encoding: the first timestamp (ms) and value in 64 bits, then the
+ * delta of delta of every timestamp and the xor of every value with the one before, about
+ * 2 bits of a sample when both are regular. A torn record at the end (a killed run) is ignored.
+ */
+static const char TSDB_MAGIC[] = "TRTSDB01";
+static const size_t TSDB_MAGIC_SIZE = 8;
+
+class TsdbBitWriter {
+public:
+    TsdbBitWriter() : bits_(0) {}
+
+    void Write(uint64_t value, int nbits);
+
+    // the last byte is padded with zero bits
+    const std::string &Data() const { return data_; }
+
+    void Clear();
+
+private:
+    std::string data_;
+    // bits used in the last byte, 0 is full
+    int bits_;
+};
+
+class TsdbBitReader {
+public:
+    explicit TsdbBitReader(const std::string &data) : data_(data), pos_(0) {}
+
+    // false past the end
+    bool Read(int nbits, uint64_t *value);
+
+private:
+    const std::string &data_;
+    size_t pos_;
+};
+
+// the samples of one series until they are written as a chunk
+class TsdbChunkEncoder {
+public:
+    TsdbChunkEncoder();
+
+    void Append(int64_t timestamp_ms, double value);
+
+    size_t Count() const { return count_; }
+
+    const std::string &Data() const { return bits_.Data(); }
+
+    void Clear();
+
+private:
+    TsdbBitWriter bits_;
+    size_t count_;
+    int64_t last_timestamp_;
+    int64_t last_delta_;
+    uint64_t last_value_;
+    int leading_;
+    int trailing_;
+};
+
+bool DecodeTsdbChunk(const std::string &data, size_t count, std::vector<std::pair<int64_t, double>> *samples);
+
+void PutVarint(std::string *out, uint64_t value);
+
+/*
+ * Reads the records of a file one by one:
+ *   while (reader.Next(&record)) ...
+ */
+class TsdbReader {
+public:
+    struct Record {
+        // 'S' or 'C'
+        char type;
+        uint64_t id;
+        // the series of 'S', the bits of 'C'
+        std::string data;
+        uint64_t count;
+    };
+
+    TsdbReader();
+
+    ~TsdbReader();
+
+    // false if it can't be opened or isn't a tsdb file
+    bool Open(const std::string &path);
+
+    // false at the end of the file or a torn record
+    bool Next(Record *record);
+
+private:
+    bool GetVarint(uint64_t *value);
+
+    FILE *file_;
+};
@@ -0,0 +1,206 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include "tsdb_recorder.hh"
+
+static std::string SeriesName(const std::string &name, const std::vector<prometheus::ClientMetric::Label> &labels,
+                              const char *extra_label = nullptr, double extra_value = 0) {
+    std::ostringstream out;
+    out << name;
+    if (labels.empty() && !extra_label) {
+        return out.str();
+    }
+    out << "{";
+    bool first = true;
+    for (auto &label : labels) {
+        out << (first ? "" : ",") << label.name << "=\"";
+        for (auto c : label.value) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            if (c == '\n') {
+                out << "\\n";
+            } else {
+                out << c;
+            }
+        }
+        out << "\"";
+        first = false;
+    }
+    if (extra_label) {
+        out << (first ? "" : ",") << extra_label << "=\"";
+        if (std::isinf(extra_value)) {
+            out << (extra_value > 0 ? "+Inf" : "-Inf");
+        } else {
+            out << std::setprecision(12) << extra_value;
+        }
+        out << "\"";
+    }
+    out << "}";
+    return out.str();
+}
+
+
+TsdbRecorder::TsdbRecorder(const std::string &path, std::chrono::milliseconds interval,
+                           std::chrono::milliseconds chunk_span)
+        : path_(path), interval_(interval), chunk_span_(chunk_span), file_(nullptr), stop_(false) {
+}
+
+TsdbRecorder::~TsdbRecorder() {
+    Stop();
+}
+
+void TsdbRecorder::Add(const std::weak_ptr<prometheus::Collectable> &collectable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    collectables_.push_back(collectable);
+}
+
+bool TsdbRecorder::Start() {
+    file_ = fopen(path_.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+    fwrite(TSDB_MAGIC, 1, TSDB_MAGIC_SIZE, file_);
+    thread_ = std::thread(std::bind(&TsdbRecorder::Run, this));
+    return true;
+}
+
+void TsdbRecorder::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        return;
+    }
+    for (auto &pair : series_) {
+        WriteChunk(&pair.second);
+    }
+    fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    buffer_.clear();
+    fclose(file_);
+    file_ = nullptr;
+}
+
+void TsdbRecorder::Run() {
+    // a round is stamped with its tick instead of the clock, regular timestamps take 1 bit a sample
+    auto start = std::chrono::steady_clock::now();
+    auto start_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    int64_t tick = 0;
+    while (true) {
+        RecordOnce(start_ms + tick * interval_.count());
+        // the ticks missed by a slow round are skipped
+        tick = std::max(tick + 1, int64_t((std::chrono::steady_clock::now() - start) / interval_));
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_cv_.wait_until(lock, start + tick * interval_, [this] { return stop_; })) {
+            return;
+        }
+    }
+}
+
+void TsdbRecorder::RecordOnce(int64_t timestamp_ms) {
+    std::vector<std::weak_ptr<prometheus::Collectable>> collectables;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        collectables = collectables_;
+    }
+    // collected without the lock, a registry may be slow to collect
+    std::vector<prometheus::MetricFamily> families;
+    for (auto &collectable : collectables) {
+        auto c = collectable.lock();
+        if (!c) {
+            continue;
+        }
+        auto collected = c->Collect();
+        families.insert(families.end(), collected.begin(), collected.end());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) {
+        return;
+    }
+    for (auto &family : families) {
+        for (auto &metric : family.metric) {
+            switch (family.type) {
+                case prometheus::MetricType::Counter:
+                    Append(SeriesName(family.name, metric.label), timestamp_ms, metric.counter.value);
+                    break;
+                case prometheus::MetricType::Gauge:
+                    Append(SeriesName(family.name, metric.label), timestamp_ms, metric.gauge.value);
+                    break;
+                case prometheus::MetricType::Untyped:
+                    Append(SeriesName(family.name, metric.label), timestamp_ms, metric.untyped.value);
+                    break;
+                case prometheus::MetricType::Summary:
+                    for (auto &quantile : metric.summary.quantile) {
+                        Append(SeriesName(family.name, metric.label, "quantile", quantile.quantile),
+                               timestamp_ms, quantile.value);
+                    }
+                    Append(SeriesName(family.name + "_sum", metric.label), timestamp_ms,
+                           metric.summary.sample_sum);
+                    Append(SeriesName(family.name + "_count", metric.label), timestamp_ms,
+                           double(metric.summary.sample_count));
+                    break;
+                case prometheus::MetricType::Histogram:
+                    for (auto &bucket : metric.histogram.bucket) {
+                        Append(SeriesName(family.name + "_bucket", metric.label, "le", bucket.upper_bound),
+                               timestamp_ms, double(bucket.cumulative_count));
+                    }
+                    Append(SeriesName(family.name + "_sum", metric.label), timestamp_ms,
+                           metric.histogram.sample_sum);
+                    Append(SeriesName(family.name + "_count", metric.label), timestamp_ms,
+                           double(metric.histogram.sample_count));
+                    break;
+            }
+        }
+    }
+    // one write a round, a killed run loses the chunks not written yet, about chunk_span
+    fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    fflush(file_);
+    buffer_.clear();
+}
+
+void TsdbRecorder::Append(const std::string &name, int64_t timestamp_ms, double value) {
+    auto it = series_.find(name);
+    if (it == series_.end()) {
+        Series series;
+        series.id = series_.size();
+        it = series_.insert(std::make_pair(name, series)).first;
+        buffer_.push_back('S');
+        PutVarint(&buffer_, series.id);
+        PutVarint(&buffer_, name.size());
+        buffer_.append(name);
+    }
+    auto &series = it->second;
+    if (series.encoder.Count() > 0 && timestamp_ms - series.first_timestamp_ms >= chunk_span_.count()) {
+        WriteChunk(&series);
+    }
+    if (series.encoder.Count() == 0) {
+        series.first_timestamp_ms = timestamp_ms;
+    }
+    series.encoder.Append(timestamp_ms, value);
+}
+
+void TsdbRecorder::WriteChunk(Series *series) {
+    if (series->encoder.Count() == 0) {
+        return;
+    }
+    buffer_.push_back('C');
+    PutVarint(&buffer_, series->id);
+    PutVarint(&buffer_, series->encoder.Count());
+    PutVarint(&buffer_, series->encoder.Data().size());
+    buffer_.append(series->encoder.Data());
+    series->encoder.Clear();
+}
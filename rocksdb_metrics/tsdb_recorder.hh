@@ -0,0 +1,70 @@
+//
+// Created by zhengcf on 2026-10-19.
+//
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <prometheus/collectable.h>
+#include <prometheus/metric_family.h>
+#include "tsdb_format.hh"
+
+
+/*
+ * Collects the added registries every interval and appends every sample to a local file (see
+ * tsdb_format.hh), for the runs without a prometheus server; trocksdb_dump exports it to csv.
+ * Histograms and summaries are split like the prometheus text format: _bucket{le=}, _sum, _count.
+ * A series is written as a chunk once it spans chunk_span and at Stop, so a killed run loses about
+ * chunk_span of every series; each chunk repeats a 16 bytes header, shorter spans make the file bigger.
+ */
+class TsdbRecorder {
+public:
+    TsdbRecorder(const std::string &path, std::chrono::milliseconds interval, std::chrono::milliseconds chunk_span);
+
+    ~TsdbRecorder();
+
+    void Add(const std::weak_ptr<prometheus::Collectable> &collectable);
+
+    // false if the file can't be created
+    bool Start();
+
+    // writes the chunks not written yet
+    void Stop();
+
+    // collects and appends once, Start calls it every interval
+    void RecordOnce(int64_t timestamp_ms);
+
+private:
+    struct Series {
+        uint64_t id;
+        int64_t first_timestamp_ms;
+        TsdbChunkEncoder encoder;
+    };
+
+    void Run();
+
+    void Append(const std::string &name, int64_t timestamp_ms, double value);
+
+    void WriteChunk(Series *series);
+
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    std::chrono::milliseconds chunk_span_;
+    FILE *file_;
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_;
+    std::vector<std::weak_ptr<prometheus::Collectable>> collectables_;
+    std::map<std::string, Series> series_;
+    // the records of a round, written at once
+    std::string buffer_;
+    std::thread thread_;
+};